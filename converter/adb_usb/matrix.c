@@ -359,7 +359,7 @@ void adb_mouse_task(void)
     }
 
     // Send result by usb.
-    host_mouse_send(&mouse_report);
+    host_mouse_add(MOUSE_SOURCE_ADB, &mouse_report);
 
     // TODO: acceleration curve is needed for precise operation?
     // increase acceleration of mouse
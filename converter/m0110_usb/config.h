@@ -59,4 +59,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define M0110_DATA_DDR          DDRD
 #define M0110_DATA_BIT          0
 
+/* uses INT1 for clock line, any edge. Remove to use polling. */
+#define M0110_INT_INIT()  do {  \
+    EICRA = (EICRA & ~((1<<ISC11) | (1<<ISC10))) | (1<<ISC10); \
+} while (0)
+#define M0110_INT_ON()  do {    \
+    EIFR  = (1<<INTF1);         \
+    EIMSK |= (1<<INT1);         \
+} while (0)
+#define M0110_INT_OFF() do {    \
+    EIMSK &= ~(1<<INT1);        \
+} while (0)
+#define M0110_INT_VECT          INT1_vect
+
 #endif
@@ -27,6 +27,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "debug.h"
 #include "host.h"
 #include "led.h"
+#include "timer.h"
 #include "m0110.h"
 #include "matrix.h"
 
@@ -43,6 +44,9 @@ static bool is_modified = false;
 static uint8_t *matrix;
 static uint8_t _matrix0[MATRIX_ROWS];
 
+static bool led_flash = false;
+static uint16_t led_time = 0;
+
 static void register_key(uint8_t key);
 
 
@@ -53,10 +57,10 @@ void matrix_init(void)
     for (uint8_t i=0; i < MATRIX_ROWS; i++) _matrix0[i] = 0x00;
     matrix = _matrix0;
 
-    // LED flash
+    // LED flash, turned off in matrix_scan
     DDRD |= (1<<6); PORTD |= (1<<6);
-    _delay_ms(500);
-    DDRD |= (1<<6); PORTD &= ~(1<<6);
+    led_flash = true;
+    led_time = timer_read();
 
     return;
 }
@@ -65,6 +69,11 @@ uint8_t matrix_scan(void)
 {
     uint8_t key;
 
+    if (led_flash && timer_elapsed(led_time) > 500) {
+        PORTD &= ~(1<<6);
+        led_flash = false;
+    }
+
     is_modified = false;
     key = m0110_recv_key();
 
@@ -33,6 +33,19 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MATRIX_ROWS 16
 #define MATRIX_COLS 16
 
+/* number of keyboards hosted
+ * Each keyboard and hub takes one of 16 device slots of UHS2 and each
+ * keyboard about 300 bytes of RAM, which is checked against
+ * USB_USB_KEYBOARDS_RAM(1280 bytes by default) at compile time. */
+#define USB_USB_KEYBOARDS 4
+
+/* interval of UHS2 USB::Task()(enumeration and hub status) in ms while
+ * keyboard is running. Input reports of keyboards are polled every scan. */
+#define USB_HOST_TASK_INTERVAL 10
+
+/* time budget of UHS2 task per scan in ms. Enumeration can't be bounded. */
+#define USB_HOST_TASK_BUDGET 2
+
 /* key combination for command */
 #define IS_COMMAND() (keyboard_report->mods == (MOD_BIT(KC_LSHIFT) | MOD_BIT(KC_RSHIFT))) 
 
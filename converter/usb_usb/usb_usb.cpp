@@ -22,7 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Usb.h"
 #include "usbhub.h"
 #include "usbhid.h"
-#include "hidboot.h"
+#include "hiduniversal.h"
 #include "parser.h"
 
 #include "keycode.h"
@@ -62,27 +62,47 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define CODE(row, col)  (((row) << 4) | (col))
 #define ROW(code)       (((code) & ROW_MASK) >> 4)
 #define COL(code)       ((code) & COL_MASK)
-#define ROW_BITS(code)  (1 << COL(code))
 
 
-// Integrated key state of all keyboards
-static report_keyboard_t keyboard_report;
+/* Integrated key state of all keyboards
+ *
+ * 256-bit bitmap indexed by HID usage ID. Usage ID equals to matrix CODE()
+ * and two bytes make up a matrix row. Modifiers(0xE0-E7) are at row 14.
+ */
+static uint8_t keyboard_keys[32];
 
 static bool matrix_is_mod =false;
 
 /*
  * USB Host Shield HID keyboards
- * This supports two cascaded hubs and four keyboards
+ * This supports two cascaded hubs and USB_USB_KEYBOARDS keyboards.
+ * Each keyboard and hub occupies a device slot of UHS2(USB_NUMDEVICES).
  */
+#ifndef USB_USB_KEYBOARDS
+#define USB_USB_KEYBOARDS   4
+#endif
+// address 0 is not for device and two hubs take their own
+#if USB_USB_KEYBOARDS + 2 >= USB_NUMDEVICES || USB_USB_KEYBOARDS > 16
+#   error "USB_USB_KEYBOARDS: too many keyboards for USB_NUMDEVICES"
+#endif
+
 USB usb_host;
-HIDBoot<USB_HID_PROTOCOL_KEYBOARD>    kbd1(&usb_host);
-HIDBoot<USB_HID_PROTOCOL_KEYBOARD>    kbd2(&usb_host);
-HIDBoot<USB_HID_PROTOCOL_KEYBOARD>    kbd3(&usb_host);
-HIDBoot<USB_HID_PROTOCOL_KEYBOARD>    kbd4(&usb_host);
-KBDReportParser kbd_parser1;
-KBDReportParser kbd_parser2;
-KBDReportParser kbd_parser3;
-KBDReportParser kbd_parser4;
+
+// default constructible so that keyboards can be an array
+class USBKBD : public KBDHID
+{
+public:
+    USBKBD() : KBDHID(&usb_host) {}
+};
+static USBKBD kbd[USB_USB_KEYBOARDS];
+
+/* RAM for keyboards in bytes, a keyboard takes about 300 bytes on AVR.
+ * Default leaves rest of 2.5KB of ATmega32u4 to LUFA, TMK core and stack. */
+#ifndef USB_USB_KEYBOARDS_RAM
+#define USB_USB_KEYBOARDS_RAM   1280
+#endif
+// compile error when USB_USB_KEYBOARDS don't fit in USB_USB_KEYBOARDS_RAM
+typedef char usb_usb_keyboards_ram_check[(sizeof(kbd) <= USB_USB_KEYBOARDS_RAM) ? 1 : -1];
 USBHub hub1(&usb_host);
 USBHub hub2(&usb_host);
 
@@ -94,64 +114,115 @@ void matrix_init(void) {
     debug_enable = true;
     // USB Host Shield setup
     usb_host.Init();
-    kbd1.SetReportParser(0, (HIDReportParser*)&kbd_parser1);
-    kbd2.SetReportParser(0, (HIDReportParser*)&kbd_parser2);
-    kbd3.SetReportParser(0, (HIDReportParser*)&kbd_parser3);
-    kbd4.SetReportParser(0, (HIDReportParser*)&kbd_parser4);
 }
 
-static void or_report(report_keyboard_t report) {
-    // integrate reports into keyboard_report
-    keyboard_report.mods |= report.mods;
-    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
-        if (IS_ANY(report.keys[i])) {
-            for (uint8_t j = 0; j < KEYBOARD_REPORT_KEYS; j++) {
-                if (! keyboard_report.keys[j]) {
-                    keyboard_report.keys[j] = report.keys[i];
-                    break;
-                }
-            }
+/*
+ * Time-sliced UHS2 task
+ *
+ * Each call has a budget of USB_HOST_TASK_BUDGET ms counted from its start.
+ * Running keyboards are polled round-robin until the deadline passes and ones
+ * left over are polled first on next call. USB::Task() for enumeration and hub
+ * status runs at most every USB_HOST_TASK_INTERVAL ms while a keyboard is
+ * running and only if budget is left, though it is not postponed longer than
+ * two intervals.
+ *
+ * The deadline can't preempt a slice: enumeration of a device still blocks
+ * within USB::Task() for tens of ms. Such a call is excluded from the budget
+ * and counted in usb_host_enum_max, while usb_host_task_max measures
+ * steady-state slice, that is, a call in which set of running keyboards
+ * doesn't change. Both are printed when updated.
+ */
+#ifndef USB_HOST_TASK_INTERVAL
+#define USB_HOST_TASK_INTERVAL  10
+#endif
+#ifndef USB_HOST_TASK_BUDGET
+#define USB_HOST_TASK_BUDGET    2
+#endif
+
+uint16_t usb_host_task_max = 0;
+uint16_t usb_host_enum_max = 0;
+
+static uint16_t kbd_ready(void)
+{
+    uint16_t ready = 0;
+    for (uint8_t i = 0; i < USB_USB_KEYBOARDS; i++) {
+        if (kbd[i].isReady()) ready |= (1U << i);
+    }
+    return ready;
+}
+
+static void usb_host_task(void)
+{
+    static uint16_t last_task = 0;
+    static uint8_t next = 0;
+    uint16_t start = timer_read();
+    uint16_t ready = kbd_ready();
+
+    // 1. poll input reports of running keyboards until deadline
+    if (ready && usb_host.getUsbTaskState() == USB_STATE_RUNNING) {
+        for (uint8_t n = 0; n < USB_USB_KEYBOARDS; n++) {
+            uint8_t i = next;
+            if (++next >= USB_USB_KEYBOARDS) next = 0;
+            if (!(ready & (1U << i))) continue;
+            kbd[i].Poll();
+            if (timer_elapsed(start) >= USB_HOST_TASK_BUDGET) break;
+        }
+    }
+
+    // 2. enumeration and hub: full rate only while no keyboard is running
+    bool task = true;
+    if (ready) {
+        uint16_t since = timer_elapsed(last_task);
+        task = (since >= USB_HOST_TASK_INTERVAL &&
+                (timer_elapsed(start) < USB_HOST_TASK_BUDGET || since >= 2 * USB_HOST_TASK_INTERVAL));
+    }
+    if (task) {
+        last_task = timer_read();
+        usb_host.Task();
+    }
+
+    uint16_t timer = timer_elapsed(start);
+    if (kbd_ready() == ready) {
+        if (timer > usb_host_task_max) {
+            usb_host_task_max = timer;
+            xprintf("host task max: %d\n", timer);
+        }
+    } else {
+        if (timer > usb_host_enum_max) {
+            usb_host_enum_max = timer;
+            xprintf("host enum max: %d\n", timer);
         }
     }
 }
 
 uint8_t matrix_scan(void) {
-    static uint16_t last_time_stamp1 = 0;
-    static uint16_t last_time_stamp2 = 0;
-    static uint16_t last_time_stamp3 = 0;
-    static uint16_t last_time_stamp4 = 0;
+    static uint16_t last_ready = 0;
+
+    usb_host_task();
+
+    // keyboard detached or attached
+    uint16_t ready = kbd_ready();
+    if (ready != last_ready) {
+        last_ready = ready;
+        KBDReportParser::changed = true;
+    }
 
     // check report came from keyboards
-    if (kbd_parser1.time_stamp != last_time_stamp1 ||
-        kbd_parser2.time_stamp != last_time_stamp2 ||
-        kbd_parser3.time_stamp != last_time_stamp3 ||
-        kbd_parser4.time_stamp != last_time_stamp4) {
-
-        last_time_stamp1 = kbd_parser1.time_stamp;
-        last_time_stamp2 = kbd_parser2.time_stamp;
-        last_time_stamp3 = kbd_parser3.time_stamp;
-        last_time_stamp4 = kbd_parser4.time_stamp;
-
-        // clear and integrate all reports
-        keyboard_report = {};
-        or_report(kbd_parser1.report);
-        or_report(kbd_parser2.report);
-        or_report(kbd_parser3.report);
-        or_report(kbd_parser4.report);
+    if (KBDReportParser::changed) {
+        KBDReportParser::changed = false;
+
+        // integrate all reports
+        ::memset(keyboard_keys, 0, sizeof(keyboard_keys));
+        for (uint8_t i = 0; i < USB_USB_KEYBOARDS; i++) {
+            if (!(ready & (1U << i))) continue;
+            kbd[i].parser.Merge(keyboard_keys);
+        }
 
         matrix_is_mod = true;
     } else {
         matrix_is_mod = false;
     }
 
-    uint16_t timer;
-    timer = timer_read();
-    usb_host.Task();
-    timer = timer_elapsed(timer);
-    if (timer > 100) {
-        xprintf("host.Task: %d\n", timer);
-    }
-
     static uint8_t usb_state = 0;
     if (usb_state != usb_host.getUsbTaskState()) {
         usb_state = usb_host.getUsbTaskState();
@@ -172,45 +243,17 @@ bool matrix_is_modified(void) {
 
 bool matrix_is_on(uint8_t row, uint8_t col) {
     uint8_t code = CODE(row, col);
-
-    if (IS_MOD(code)) {
-        if (keyboard_report.mods & ROW_BITS(code)) {
-            return true;
-        }
-    }
-    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
-        if (keyboard_report.keys[i] == code) {
-            return true;
-        }
-    }
-    return false;
+    return keyboard_keys[code / 8] & (1 << (code % 8));
 }
 
 matrix_row_t matrix_get_row(uint8_t row) {
-    uint16_t row_bits = 0;
-
-    if (IS_MOD(CODE(row, 0)) && keyboard_report.mods) {
-        row_bits |= keyboard_report.mods;
-    }
-
-    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
-        if (IS_ANY(keyboard_report.keys[i])) {
-            if (row == ROW(keyboard_report.keys[i])) {
-                row_bits |= ROW_BITS(keyboard_report.keys[i]);
-            }
-        }
-    }
-    return row_bits;
+    return keyboard_keys[row * 2] | (keyboard_keys[row * 2 + 1] << 8);
 }
 
 uint8_t matrix_key_count(void) {
     uint8_t count = 0;
-
-    count += bitpop(keyboard_report.mods);
-    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
-        if (IS_ANY(keyboard_report.keys[i])) {
-            count++;
-        }
+    for (uint8_t i = 0; i < sizeof(keyboard_keys); i++) {
+        count += bitpop(keyboard_keys[i]);
     }
     return count;
 }
@@ -220,10 +263,9 @@ void matrix_print(void) {
 
 void led_set(uint8_t usb_led)
 {
-    if (kbd1.isReady()) kbd1.SetReport(0, 0, 2, 0, 1, &usb_led);
-    if (kbd2.isReady()) kbd2.SetReport(0, 0, 2, 0, 1, &usb_led);
-    if (kbd3.isReady()) kbd3.SetReport(0, 0, 2, 0, 1, &usb_led);
-    if (kbd4.isReady()) kbd4.SetReport(0, 0, 2, 0, 1, &usb_led);
+    for (uint8_t i = 0; i < USB_USB_KEYBOARDS; i++) {
+        if (kbd[i].isReady()) kbd[i].SetLED(usb_led);
+    }
 }
 
 // We need to keep doing UHS2 USB::Task() to initialize keyboard
@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <stdint.h>
 #include <stdbool.h>
 #include <avr/io.h>
+#include <avr/interrupt.h>
 #include <util/delay.h>
 #include "print.h"
 #include "debug.h"
@@ -170,3 +171,34 @@ static void select_row(uint8_t row)
             break;
     }
 }
+
+/* Wake from suspend on key press
+ * All rows are selected and change of column pins B0-B7 raises PCINT0.
+ */
+bool matrix_wakeup_enable(void)
+{
+    DDRD  |=  0b01111111;
+    PORTD &= ~0b01111111;
+    DDRC  |=  0b00000100;
+    PORTC &= ~0b00000100;
+    _delay_us(30);  // delay for settling
+
+    // key held down can't make change to wake
+    if (read_cols()) {
+        unselect_rows();
+        return false;
+    }
+    PCIFR  = (1<<PCIF0);
+    PCMSK0 = 0b11111111;
+    PCICR |= (1<<PCIE0);
+    return true;
+}
+
+void matrix_wakeup_disable(void)
+{
+    PCICR &= ~(1<<PCIE0);
+    PCMSK0 = 0;
+    unselect_rows();
+}
+
+EMPTY_INTERRUPT(PCINT0_vect);
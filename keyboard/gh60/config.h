@@ -31,6 +31,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MATRIX_ROWS 5
 #define MATRIX_COLS 14
 
+/* pins for MATRIX_PINS_ENABLE, Rev.A only: Rev.B has column 8 on B7 */
+#define MATRIX_ROW_PINS(X)  X(D,0) X(D,1) X(D,2) X(D,3) X(D,5)
+#define MATRIX_COL_PINS(X)  X(F,0,2) X(E,6) X(C,7) X(C,6) X(B,6) X(D,4) X(B,1) X(B,0) X(B,5) X(B,4) X(D,7) X(D,6) X(B,3)
+
 /* define if matrix has ghost */
 //#define MATRIX_HAS_GHOST
 
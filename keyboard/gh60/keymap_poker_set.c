@@ -61,6 +61,7 @@ const uint8_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
         TRNS,DEL, TRNS,WHOM,MUTE,VOLU,VOLD,TRNS,PGUP,PGDN,DEL,           PGUP, \
         TRNS,TRNS,TRNS,          FN6,                     FN7, HOME,PGDN,END),
 };
+const uint16_t keymaps_size = sizeof(keymaps);
 
 /*
  * Fn action definition
@@ -68,6 +68,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
     #define SERIAL_UART_UBRR        ((F_CPU/(16.0*SERIAL_UART_BAUD)-1+0.5))
     #define SERIAL_UART_RXD_VECT    USART1_RX_vect
     #define SERIAL_UART_TXD_READY   (UCSR1A&(1<<UDRE1))
+    #define SERIAL_UART_TXD_VECT    USART1_UDRE_vect
+    #define SERIAL_UART_TXD_INT_ON()    do { UCSR1B |=  (1<<UDRIE1); } while (0)
+    #define SERIAL_UART_TXD_INT_OFF()   do { UCSR1B &= ~(1<<UDRIE1); } while (0)
     #define SERIAL_UART_INIT()      do { \
         UBRR1L = (uint8_t) SERIAL_UART_UBRR;       /* baud rate */ \
         UBRR1H = ((uint16_t)SERIAL_UART_UBRR>>8);  /* baud rate */ \
@@ -184,7 +184,16 @@ static void send_keyboard(report_keyboard_t *report)
     serial_send(report->keys[5]);
 }
 
-static void send_mouse(report_mouse_t *report)
+/*
+ * Mouse report is held while UART TX buffer has no room for it, when RN-42
+ * falls behind, and motion of following reports is merged into it. Merging
+ * stops at button change or overflow of motion so that nothing is lost.
+ */
+#define MOUSE_REPORT_SIZE   7
+static report_mouse_t mouse_pending;
+static bool mouse_pending_valid = false;
+
+static void send_mouse_report(report_mouse_t *report)
 {
     // wake from deep sleep
 /*
@@ -202,6 +211,42 @@ static void send_mouse(report_mouse_t *report)
     serial_send(report->v);
 }
 
+static bool merge(int8_t *a, int8_t b)
+{
+    int16_t sum = *a + b;
+    if (sum < -127 || sum > 127) return false;
+    *a = sum;
+    return true;
+}
+
+static void send_mouse(report_mouse_t *report)
+{
+    if (mouse_pending_valid) {
+        report_mouse_t m = mouse_pending;
+        if (report->buttons == m.buttons &&
+                merge(&m.x, report->x) && merge(&m.y, report->y) &&
+                merge(&m.v, report->v)) {
+            mouse_pending = m;
+            rn42_flush();
+            return;
+        }
+        // wait for room
+        send_mouse_report(&mouse_pending);
+    }
+    mouse_pending = *report;
+    mouse_pending_valid = true;
+    rn42_flush();
+}
+
+/* Send held report when UART has room, called from rn42_task */
+void rn42_flush(void)
+{
+    if (mouse_pending_valid && serial_send_space() >= MOUSE_REPORT_SIZE) {
+        send_mouse_report(&mouse_pending);
+        mouse_pending_valid = false;
+    }
+}
+
 static void send_system(uint16_t data)
 {
     // Table 5-6 of RN-BT-DATA-UB
@@ -41,6 +41,9 @@ void rn42_task_init(void)
 void rn42_task(void)
 {
     int16_t c;
+    // send report held back by busy UART
+    rn42_flush();
+
     // Raw mode: interpret output report of LED state
     while ((c = rn42_getc()) != -1) {
         // LED Out report: 0xFE, 0x02, 0x01, <leds>
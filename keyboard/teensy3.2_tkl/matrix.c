@@ -26,11 +26,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util.h"
 #include "matrix.h"
 #include "wait.h"
+#include "timer.h"
+#ifdef MATRIX_BG_ENABLE
+#include "matrix_bg.h"
+#endif
 
 #ifndef DEBOUNCE
 #   define DEBOUNCE 5
 #endif
 static uint8_t debouncing = DEBOUNCE;
+#ifdef MATRIX_BG_ENABLE
+static uint16_t debouncing_time = 0;
+#endif
 
 /* matrix state(1:on, 0:off) */
 static matrix_row_t matrix[MATRIX_ROWS];
@@ -75,19 +82,46 @@ void matrix_init(void)
     LED_ON();
     wait_ms(500);
     LED_OFF();
+
+#ifdef MATRIX_BG_ENABLE
+    matrix_bg_start();
+#endif
 }
 
 uint8_t matrix_scan(void)
 {
+#ifdef MATRIX_BG_ENABLE
+    // rows are scanned in timer interrupt, see matrix_bg.c
+    matrix_row_t rows[MATRIX_ROWS];
+    if (matrix_bg_read(rows)) {
+        for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+            if (matrix_debouncing[i] != rows[i]) {
+                matrix_debouncing[i] = rows[i];
+                debouncing = DEBOUNCE;
+                debouncing_time = timer_read();
+            }
+        }
+    }
+
+    if (debouncing && timer_elapsed(debouncing_time) >= DEBOUNCE) {
+        for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+            matrix[i] = matrix_debouncing[i];
+        }
+        debouncing = 0;
+    }
+#else
     for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
         select_row(i);
         wait_us(30);  // without this wait read unstable value.
         matrix_row_t cols = read_cols();
         if (matrix_debouncing[i] != cols) {
             matrix_debouncing[i] = cols;
+#ifndef SCAN_THREAD_ENABLE
+            // console is not thread-safe, scan thread doesn't print
             if (debouncing) {
                 debug("bounce!: "); debug_hex(debouncing); debug("\n");
             }
+#endif
             debouncing = DEBOUNCE;
         }
         unselect_rows();
@@ -102,6 +136,7 @@ uint8_t matrix_scan(void)
             }
         }
     }
+#endif
 
     return 1;
 }
@@ -219,3 +254,9 @@ static void select_row(uint8_t row)
             break;
     }
 }
+
+#ifdef MATRIX_BG_ENABLE
+void matrix_bg_select_row(uint8_t row) { select_row(row); }
+void matrix_bg_unselect_rows(void) { unselect_rows(); }
+matrix_row_t matrix_bg_read_cols(void) { return read_cols(); }
+#endif
@@ -11,6 +11,7 @@ SRC +=	$(COMMON_DIR)/host.c \
 	$(COMMON_DIR)/debug.c \
 	$(COMMON_DIR)/util.c \
 	$(COMMON_DIR)/hook.c \
+	$(COMMON_DIR)/ghost.c \
 	$(COMMON_DIR)/avr/suspend.c \
 	$(COMMON_DIR)/avr/xprintf.S \
 	$(COMMON_DIR)/avr/timer.c \
@@ -22,6 +23,12 @@ ifeq (yes,$(strip $(UNIMAP_ENABLE)))
     SRC += $(COMMON_DIR)/unimap.c
     OPT_DEFS += -DUNIMAP_ENABLE
     OPT_DEFS += -DACTIONMAP_ENABLE
+    ifeq (yes,$(strip $(UNIMAP_PRECOMPOSE)))
+	OPT_DEFS += -DUNIMAP_PRECOMPOSE
+    else ifeq (sparse,$(strip $(UNIMAP_PRECOMPOSE)))
+	OPT_DEFS += -DUNIMAP_PRECOMPOSE
+	OPT_DEFS += -DUNIMAP_SPARSE
+    endif
 else
     ifeq (yes,$(strip $(ACTIONMAP_ENABLE)))
 	SRC += $(COMMON_DIR)/actionmap.c
@@ -33,7 +40,7 @@ endif
 
 ifeq (yes,$(strip $(BOOTMAGIC_ENABLE)))
     SRC += $(COMMON_DIR)/bootmagic.c
-    SRC += $(COMMON_DIR)/avr/eeconfig.c
+    SRC += $(COMMON_DIR)/eeconfig.c
     OPT_DEFS += -DBOOTMAGIC_ENABLE
 endif
 
@@ -58,6 +65,46 @@ else
     endif
 endif
 
+ifeq (yes,$(strip $(TLOG_ENABLE)))
+    SRC += $(COMMON_DIR)/tlog.c
+    OPT_DEFS += -DTLOG_ENABLE
+endif
+
+ifeq (yes,$(strip $(PROFILE_ENABLE)))
+    SRC += $(COMMON_DIR)/profile.c
+    OPT_DEFS += -DPROFILE_ENABLE
+endif
+
+ifeq (yes,$(strip $(LATENCY_ENABLE)))
+    SRC += $(COMMON_DIR)/latency.c
+    OPT_DEFS += -DLATENCY_ENABLE
+endif
+
+ifeq (yes,$(strip $(TRACE_ENABLE)))
+    SRC += $(COMMON_DIR)/trace.c
+    OPT_DEFS += -DTRACE_ENABLE
+endif
+
+ifeq (yes,$(strip $(SOF_SYNC_ENABLE)))
+    SRC += $(COMMON_DIR)/sof_sync.c
+    OPT_DEFS += -DSOF_SYNC_ENABLE
+endif
+
+ifeq (yes,$(strip $(POWERSAVE_ENABLE)))
+    SRC += $(COMMON_DIR)/powersave.c
+    OPT_DEFS += -DPOWERSAVE_ENABLE
+endif
+
+ifeq (yes,$(strip $(EEKEYMAP_ENABLE)))
+    SRC += $(COMMON_DIR)/eekeymap.c
+    OPT_DEFS += -DEEKEYMAP_ENABLE
+endif
+
+ifeq (yes,$(strip $(MATRIX_PINS_ENABLE)))
+    SRC += $(COMMON_DIR)/avr/matrix_pins.c
+    OPT_DEFS += -DMATRIX_PINS_ENABLE
+endif
+
 ifeq (yes,$(strip $(NO_DEBUG)))
     OPT_DEFS += -DNO_DEBUG
 endif
@@ -29,6 +29,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "hook.h"
 #include "wait.h"
 #include "bootloader.h"
+#include "profile.h"
+#include "latency.h"
 
 #ifdef DEBUG_ACTION
 #include "debug.h"
@@ -47,14 +49,19 @@ void action_exec(keyevent_t event)
 
     keyrecord_t record = { .event = event };
 
+    PROFILE_BEGIN(ACTION_EXEC);
 #ifndef NO_ACTION_TAPPING
+    PROFILE_BEGIN(TAPPING);
     action_tapping_process(record);
+    PROFILE_END(TAPPING);
 #else
     process_action(&record);
     if (!IS_NOEVENT(record.event)) {
         dprint("processed: "); debug_record(record); dprintln();
     }
 #endif
+    latency_event_end();
+    PROFILE_END(ACTION_EXEC);
 }
 
 void process_action(keyrecord_t *record)
@@ -67,6 +74,7 @@ void process_action(keyrecord_t *record)
 #endif
 
     if (IS_NOEVENT(event)) { return; }
+    latency_event(event);
 
     action_t action = layer_switch_get_action(event);
     dprint("ACTION: "); debug_action(action);
@@ -3,6 +3,7 @@
 #include "action.h"
 #include "util.h"
 #include "action_layer.h"
+#include "matrix.h"
 #include "hook.h"
 
 #ifdef DEBUG_ACTION
@@ -143,8 +144,75 @@ static uint8_t current_layer_for_key(keypos_t key)
 
 
 #ifndef NO_TRACK_KEY_PRESS
-/* record layer on where key is pressed */
+/*
+ * Record layer on where key is pressed
+ *
+ * Layer number is stored in bitplanes of matrix rows, LAYER_PRESSED_BITS
+ * bits per key, when they take less RAM than a byte per key. Bitplanes take
+ * LAYER_PRESSED_BITS * sizeof(matrix_row_t) bytes per row against
+ * MATRIX_COLS bytes, so it depends on row width: with 5 bits 16 columns
+ * take 10 bytes instead of 16, while 9 or 17 to 20 columns don't save and
+ * use a byte per key. Define LAYER_PRESSED_BITS smaller in config.h if
+ * keymap has fewer layers, e.g. 2 for 4 layers.
+ *
+ * With less than 5 bits the largest value marks a layer which doesn't fit;
+ * such key is looked up again on release as with NO_TRACK_KEY_PRESS.
+ */
+#ifndef LAYER_PRESSED_BITS
+#define LAYER_PRESSED_BITS  5
+#endif
+#if (LAYER_PRESSED_BITS < 1 || LAYER_PRESSED_BITS > 5)
+#   error "LAYER_PRESSED_BITS should be 1 to 5."
+#endif
+#define LAYER_PRESSED_ROW_BYTES (MATRIX_COLS <= 8 ? 1 : MATRIX_COLS <= 16 ? 2 : 4)
+
+#if (LAYER_PRESSED_BITS * LAYER_PRESSED_ROW_BYTES < MATRIX_COLS)
+#if (LAYER_PRESSED_BITS < 5)
+#   define LAYER_PRESSED_NONE   ((1<<LAYER_PRESSED_BITS) - 1)
+#endif
+static matrix_row_t layer_pressed[LAYER_PRESSED_BITS][MATRIX_ROWS] = {};
+
+static void layer_pressed_set(keypos_t key, uint8_t layer)
+{
+    matrix_row_t bit = (matrix_row_t)1<<key.col;
+#ifdef LAYER_PRESSED_NONE
+    if (layer > LAYER_PRESSED_NONE) layer = LAYER_PRESSED_NONE;
+#endif
+    for (uint8_t i = 0; i < LAYER_PRESSED_BITS; i++) {
+        if (layer & (1<<i)) {
+            layer_pressed[i][key.row] |= bit;
+        } else {
+            layer_pressed[i][key.row] &= ~bit;
+        }
+    }
+}
+
+static uint8_t layer_pressed_get(keypos_t key)
+{
+    uint8_t layer = 0;
+    for (uint8_t i = 0; i < LAYER_PRESSED_BITS; i++) {
+        if (layer_pressed[i][key.row] & ((matrix_row_t)1<<key.col)) {
+            layer |= (1<<i);
+        }
+    }
+#ifdef LAYER_PRESSED_NONE
+    if (layer == LAYER_PRESSED_NONE) return current_layer_for_key(key);
+#endif
+    return layer;
+}
+#else
 static uint8_t layer_pressed[MATRIX_ROWS][MATRIX_COLS] = {};
+
+static void layer_pressed_set(keypos_t key, uint8_t layer)
+{
+    layer_pressed[key.row][key.col] = layer;
+}
+
+static uint8_t layer_pressed_get(keypos_t key)
+{
+    return layer_pressed[key.row][key.col];
+}
+#endif
 #endif
 action_t layer_switch_get_action(keyevent_t event)
 {
@@ -154,9 +222,9 @@ action_t layer_switch_get_action(keyevent_t event)
 #ifndef NO_TRACK_KEY_PRESS
     if (event.pressed) {
         layer = current_layer_for_key(event.key);
-        layer_pressed[event.key.row][event.key.col] = layer;
+        layer_pressed_set(event.key, layer);
     } else {
-        layer = layer_pressed[event.key.row][event.key.col];
+        layer = layer_pressed_get(event.key);
     }
 #else
     layer = current_layer_for_key(event.key);
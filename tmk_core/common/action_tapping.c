@@ -2,6 +2,7 @@
 #include <stdbool.h>
 #include "action.h"
 #include "action_layer.h"
+#include "action_util.h"
 #include "action_tapping.h"
 #include "keycode.h"
 #include "timer.h"
@@ -18,15 +19,20 @@
 #define IS_TAPPING_PRESSED()    (IS_TAPPING() && tapping_key.event.pressed)
 #define IS_TAPPING_RELEASED()   (IS_TAPPING() && !tapping_key.event.pressed)
 #define IS_TAPPING_KEY(k)       (IS_TAPPING() && KEYEQ(tapping_key.event.key, (k)))
-#define WITHIN_TAPPING_TERM(e)  (TIMER_DIFF_16(e.time, tapping_key.event.time) < TAPPING_TERM)
+#define WITHIN_TAPPING_TERM(e)  (TIMER_DIFF_16(e.time, tapping_key.event.time) < tapping_term)
 
 
 static keyrecord_t tapping_key = {};
+static uint16_t tapping_term = TAPPING_TERM;
+static uint8_t tapping_policy = TAPPING_POLICY;
+static bool tapping_eager = false;     // hold of tapping key is registered
 static keyrecord_t waiting_buffer[WAITING_BUFFER_SIZE] = {};
 static uint8_t waiting_buffer_head = 0;
 static uint8_t waiting_buffer_tail = 0;
 
 static bool process_tapping(keyrecord_t *record);
+static void start_tapping(keyrecord_t *keyp);
+static bool process_eager(keyrecord_t *keyp);
 static bool waiting_buffer_enq(keyrecord_t record);
 static void waiting_buffer_clear(void);
 static bool waiting_buffer_typed(keyevent_t event);
@@ -48,6 +54,7 @@ void action_tapping_process(keyrecord_t record)
             clear_keyboard();
             waiting_buffer_clear();
             tapping_key = (keyrecord_t){};
+            tapping_eager = false;
         }
     }
 
@@ -69,6 +76,99 @@ void action_tapping_process(keyrecord_t record)
 }
 
 
+__attribute__ ((weak))
+uint16_t action_tapping_term(keyevent_t event, action_t action)
+{
+    (void)event;
+    (void)action;
+    return TAPPING_TERM;
+}
+
+__attribute__ ((weak))
+uint8_t action_tapping_policy(keyevent_t event, action_t action)
+{
+    (void)event;
+    (void)action;
+    return TAPPING_POLICY;
+}
+
+/* tap key which registers keycode on tap and other action on hold */
+static bool is_dual_role(action_t action)
+{
+    switch (action.kind.id) {
+        case ACT_LMODS_TAP:
+        case ACT_RMODS_TAP:
+            // not oneshot nor tap toggle
+            return action.key.code >= KC_A;
+        case ACT_LAYER_TAP:
+        case ACT_LAYER_TAP_EXT:
+            return action.layer_tap.code >= KC_A && action.layer_tap.code <= KC_RGUI &&
+                   !(action.layer_tap.code >= 0xc0 && action.layer_tap.code <= 0xdf);
+    }
+    return false;
+}
+
+/* Start tapping with new tap key press, hold is registered at once in eager policy */
+static void start_tapping(keyrecord_t *keyp)
+{
+    action_t action = layer_switch_get_action(keyp->event);
+    tapping_key = *keyp;
+    tapping_term = action_tapping_term(keyp->event, action);
+    tapping_policy = action_tapping_policy(keyp->event, action);
+    tapping_eager = false;
+    if ((tapping_policy & TAPPING_EAGER_HOLD) && is_dual_role(action)) {
+        debug("Tapping: Eager hold.\n");
+        tapping_eager = true;
+        process_action(&tapping_key);
+    }
+}
+
+/* Tapping key whose hold is registered already. Other keys are not held back. */
+static bool process_eager(keyrecord_t *keyp)
+{
+    keyevent_t event = keyp->event;
+
+    if (IS_TAPPING_KEY(event.key) && !event.pressed) {
+        tapping_eager = false;
+        if (WITHIN_TAPPING_TERM(event)) {
+            debug("Tapping: Eager hold retracted. Tap(0->1).\n");
+#ifdef TAPPING_CANCEL_KEY
+            // keep host from taking lone modifier as its tap, e.g. Alt or Gui
+            if (get_mods()) {
+                register_code(TAPPING_CANCEL_KEY);
+                unregister_code(TAPPING_CANCEL_KEY);
+            }
+#endif
+            // release hold
+            process_action(keyp);
+            tapping_key.tap.count = 1;
+            process_action(&tapping_key);
+            keyp->tap = tapping_key.tap;
+            process_action(keyp);
+            // for sequential tap
+            tapping_key = *keyp;
+        } else {
+            debug("Tapping: Eager hold released.\n");
+            process_action(keyp);
+            tapping_key = (keyrecord_t){};
+        }
+        debug_tapping_key();
+        return true;
+    }
+
+    if (IS_PRESSED(event) || !WITHIN_TAPPING_TERM(event)) {
+        debug("Tapping: End. Eager hold.\n");
+        tapping_eager = false;
+        tapping_key = (keyrecord_t){};
+        debug_tapping_key();
+        // not tapping now, other tap key starts tapping
+        return process_tapping(keyp);
+    }
+    process_action(keyp);
+    return true;
+}
+
+
 /* Tapping
  *
  * Rule: Tap key is typed(pressed and released) within TAPPING_TERM.
@@ -80,7 +180,9 @@ bool process_tapping(keyrecord_t *keyp)
     keyevent_t event = keyp->event;
 
     // if tapping
-    if (IS_TAPPING_PRESSED()) {
+    if (IS_TAPPING_PRESSED() && tapping_eager) {
+        return process_eager(keyp);
+    } else if (IS_TAPPING_PRESSED()) {
         if (WITHIN_TAPPING_TERM(event)) {
             if (tapping_key.tap.count == 0) {
                 if (IS_TAPPING_KEY(event.key) && !event.pressed) {
@@ -95,12 +197,12 @@ bool process_tapping(keyrecord_t *keyp)
                     // enqueue
                     return false;
                 }
-#if TAPPING_TERM >= 500
                 /* Process a key typed within TAPPING_TERM
                  * This can register the key before settlement of tapping,
                  * useful for long TAPPING_TERM but may prevent fast typing.
                  */
-                else if (IS_RELEASED(event) && waiting_buffer_typed(event)) {
+                else if ((tapping_policy & TAPPING_PERMISSIVE_HOLD) &&
+                         IS_RELEASED(event) && waiting_buffer_typed(event)) {
                     debug("Tapping: End. No tap. Interfered by typing key\n");
                     process_action(&tapping_key);
                     tapping_key = (keyrecord_t){};
@@ -108,7 +210,6 @@ bool process_tapping(keyrecord_t *keyp)
                     // enqueue
                     return false;
                 }
-#endif
                 /* Process release event of a key pressed before tapping starts
                  * Without this unexpected repeating will occur with having fast repeating setting
                  * https://github.com/tmk/tmk_keyboard/issues/60
@@ -165,7 +266,7 @@ bool process_tapping(keyrecord_t *keyp)
                     } else {
                         debug("Tapping: Start while last tap(1).\n");
                     }
-                    tapping_key = *keyp;
+                    start_tapping(keyp);
                     waiting_buffer_scan_tap();
                     debug_tapping_key();
                     return true;
@@ -209,7 +310,7 @@ bool process_tapping(keyrecord_t *keyp)
                     } else {
                         debug("Tapping: Start while last timeout tap(1).\n");
                     }
-                    tapping_key = *keyp;
+                    start_tapping(keyp);
                     waiting_buffer_scan_tap();
                     debug_tapping_key();
                     return true;
@@ -238,13 +339,13 @@ bool process_tapping(keyrecord_t *keyp)
                         return true;
                     } else {
                         // FIX: start new tap again
-                        tapping_key = *keyp;
+                        start_tapping(keyp);
                         return true;
                     }
                 } else if (is_tap_key(event)) {
                     // Sequential tap can be interfered with other tap key.
                     debug("Tapping: Start with interfering other tap.\n");
-                    tapping_key = *keyp;
+                    start_tapping(keyp);
                     waiting_buffer_scan_tap();
                     debug_tapping_key();
                     return true;
@@ -274,7 +375,7 @@ bool process_tapping(keyrecord_t *keyp)
     else {
         if (event.pressed && is_tap_key(event)) {
             debug("Tapping: Start(Press tap key).\n");
-            tapping_key = *keyp;
+            start_tapping(keyp);
             waiting_buffer_scan_tap();
             debug_tapping_key();
             return true;
@@ -289,6 +390,11 @@ bool process_tapping(keyrecord_t *keyp)
 /*
  * Waiting buffer
  */
+uint8_t action_tapping_waiting(void)
+{
+    return (waiting_buffer_head + WAITING_BUFFER_SIZE - waiting_buffer_tail) % WAITING_BUFFER_SIZE;
+}
+
 bool waiting_buffer_enq(keyrecord_t record)
 {
     if (IS_NOEVENT(record.event)) {
@@ -328,6 +434,8 @@ void waiting_buffer_scan_tap(void)
 {
     // tapping already is settled
     if (tapping_key.tap.count > 0) return;
+    // hold is registered already
+    if (tapping_eager) return;
     // invalid state: tapping_key released && tap.count == 0
     if (!tapping_key.event.pressed) return;
 
@@ -17,6 +17,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef ACTION_TAPPING_H
 #define ACTION_TAPPING_H
 
+#include <stdint.h>
+#include "action.h"
 
 
 /* period of tapping(ms) */
@@ -29,11 +31,38 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define TAPPING_TOGGLE  5
 #endif
 
+/* Tapping policy: how tap key is settled before release or TAPPING_TERM
+ *
+ * TAPPING_PERMISSIVE_HOLD: hold as soon as other key is pressed and released
+ *                          while tap key is held
+ * TAPPING_EAGER_HOLD:      hold is registered on press so that other keys are
+ *                          not held back, and retracted when it is tapped.
+ *                          Only for tap key with keycode(ACTION_MODS_TAP_KEY
+ *                          and ACTION_LAYER_TAP_KEY).
+ */
+#define TAPPING_PERMISSIVE_HOLD (1<<0)
+#define TAPPING_EAGER_HOLD      (1<<1)
+
+/* default policy */
+#ifndef TAPPING_POLICY
+#   if TAPPING_TERM >= 500
+#       define TAPPING_POLICY   TAPPING_PERMISSIVE_HOLD
+#   else
+#       define TAPPING_POLICY   0
+#   endif
+#endif
+
 #define WAITING_BUFFER_SIZE 8
 
 
 #ifndef NO_ACTION_TAPPING
 void action_tapping_process(keyrecord_t record);
+/* number of events held in waiting buffer */
+uint8_t action_tapping_waiting(void);
+
+/* TAPPING_TERM and TAPPING_POLICY per tap key, can be redefined in keymap */
+uint16_t action_tapping_term(keyevent_t event, action_t action);
+uint8_t action_tapping_policy(keyevent_t event, action_t action);
 #endif
 
 #endif
@@ -0,0 +1,169 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Generic matrix scanner from pin table in config.h(MATRIX_PINS_ENABLE)
+ *
+ * Pins are listed as X-macros of port letter and bit, in order of row and
+ * column. Column pins on ascending bits of a port can be given as a run of
+ * port, first bit and count:
+ *
+ *     #define MATRIX_ROW_PINS(X)  X(D,0) X(D,1) X(D,2) X(D,3) X(D,5)
+ *     #define MATRIX_COL_PINS(X)  X(F,0,2) X(E,6) X(C,7) X(C,6) ...
+ *
+ * Rows are selected with output low and columns are read with pull-up. The
+ * tables are expanded at compile time into straight code: scan of each row
+ * is unrolled with constant port and bit, every port is read once per row
+ * and each column entry is one shift and mask of the snapshot, so a run
+ * takes its bits at once while a single pin costs the same per bit.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/io.h>
+#include <util/delay.h>
+#include "debug.h"
+#include "timer.h"
+#include "matrix.h"
+
+
+#if !defined(MATRIX_ROW_PINS) || !defined(MATRIX_COL_PINS)
+#   error "MATRIX_ROW_PINS and MATRIX_COL_PINS should be defined in config.h."
+#endif
+
+/* count of run, 1 when omitted */
+#define RUN_LEN(...)            RUN_LEN_(, ##__VA_ARGS__, 1)
+#define RUN_LEN_(_, n, ...)     n
+#define RUN_MASK(...)           ((1<<RUN_LEN(__VA_ARGS__)) - 1)
+
+#define PIN_COUNT(port, bit, ...)   + RUN_LEN(__VA_ARGS__)
+#if (0 MATRIX_ROW_PINS(PIN_COUNT)) != MATRIX_ROWS
+#   error "MATRIX_ROW_PINS doesn't match MATRIX_ROWS."
+#endif
+#if (0 MATRIX_COL_PINS(PIN_COUNT)) != MATRIX_COLS
+#   error "MATRIX_COL_PINS doesn't match MATRIX_COLS."
+#endif
+
+#ifndef DEBOUNCE
+#   define DEBOUNCE     5
+#endif
+
+/* us to settle after row is selected */
+#ifndef MATRIX_SELECT_DELAY
+#   define MATRIX_SELECT_DELAY  1
+#endif
+
+static bool debouncing = false;
+static uint16_t debouncing_time = 0;
+
+/* matrix state(1:on, 0:off) */
+static matrix_row_t matrix[MATRIX_ROWS];
+static matrix_row_t matrix_debouncing[MATRIX_ROWS];
+
+
+/* Input with pull-up(DDR:0, PORT:1) */
+#define COL_INIT(port, bit, ...)    DDR##port &= ~(RUN_MASK(__VA_ARGS__)<<bit); \
+                                    PORT##port |= (RUN_MASK(__VA_ARGS__)<<bit);
+/* Hi-Z(DDR:0, PORT:0) to unselect */
+#define ROW_UNSELECT(port, bit)     DDR##port &= ~(1<<bit); PORT##port &= ~(1<<bit);
+/* Output low(DDR:1, PORT:0) to select */
+#define ROW_SELECT(port, bit)       DDR##port |= (1<<bit); PORT##port &= ~(1<<bit);
+/* Columns from snapshot of port; col is constant after unrolling */
+#define COL_READ(port, bit, ...)    cols |= (matrix_row_t)((uint8_t)(~pin##port >> bit) & RUN_MASK(__VA_ARGS__)) << col; \
+                                    col += RUN_LEN(__VA_ARGS__);
+/* Scan a row */
+#define ROW_SCAN(port, bit)         ROW_SELECT(port, bit) \
+                                    _delay_us(MATRIX_SELECT_DELAY); \
+                                    scan_row(row++, read_cols()); \
+                                    ROW_UNSELECT(port, bit)
+
+static void init_cols(void)
+{
+    MATRIX_COL_PINS(COL_INIT)
+}
+
+static void unselect_rows(void)
+{
+    MATRIX_ROW_PINS(ROW_UNSELECT)
+}
+
+static inline __attribute__ ((always_inline)) matrix_row_t read_cols(void)
+{
+    // ports not in the table are read too, but an IN costs only a cycle
+#ifdef PINA
+    uint8_t pinA __attribute__ ((unused)) = PINA;
+#endif
+#ifdef PINB
+    uint8_t pinB __attribute__ ((unused)) = PINB;
+#endif
+#ifdef PINC
+    uint8_t pinC __attribute__ ((unused)) = PINC;
+#endif
+#ifdef PIND
+    uint8_t pinD __attribute__ ((unused)) = PIND;
+#endif
+#ifdef PINE
+    uint8_t pinE __attribute__ ((unused)) = PINE;
+#endif
+#ifdef PINF
+    uint8_t pinF __attribute__ ((unused)) = PINF;
+#endif
+    matrix_row_t cols = 0;
+    uint8_t col = 0;
+    MATRIX_COL_PINS(COL_READ)
+    return cols;
+}
+
+
+void matrix_init(void)
+{
+    unselect_rows();
+    init_cols();
+
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        matrix[i] = 0;
+        matrix_debouncing[i] = 0;
+    }
+}
+
+static inline __attribute__ ((always_inline)) void scan_row(uint8_t row, matrix_row_t cols)
+{
+    if (matrix_debouncing[row] != cols) {
+        matrix_debouncing[row] = cols;
+        debouncing = true;
+        debouncing_time = timer_read();
+    }
+}
+
+uint8_t matrix_scan(void)
+{
+    uint8_t row = 0;
+    MATRIX_ROW_PINS(ROW_SCAN)
+
+    if (debouncing && timer_elapsed(debouncing_time) >= DEBOUNCE) {
+        for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+            matrix[i] = matrix_debouncing[i];
+        }
+        debouncing = false;
+    }
+
+    return 1;
+}
+
+matrix_row_t matrix_get_row(uint8_t row)
+{
+    return matrix[row];
+}
@@ -8,6 +8,7 @@
 #include "suspend_avr.h"
 #include "suspend.h"
 #include "timer.h"
+#include "eeconfig.h"
 #ifdef PROTOCOL_LUFA
 #include "lufa.h"
 #endif
@@ -44,15 +45,22 @@ __asm__ __volatile__ (  \
  *          WDTO_8S
  */
 static uint8_t wdt_timeout = 0;
+static bool key_wakeup = false;
 static void power_down(uint8_t wdto)
 {
 #ifdef PROTOCOL_LUFA
     if (USB_DeviceState == DEVICE_STATE_Configured) return;
 #endif
-    wdt_timeout = wdto;
+    // Sleep until key interrupt if matrix supports it, otherwise wake up with
+    // watchdog to scan matrix. Once woken by interrupt watchdog is used until
+    // matrix is scanned with suspend_wakeup_condition.
+    bool key_intr = !key_wakeup && matrix_wakeup_enable();
+    if (!key_intr) {
+        wdt_timeout = wdto;
 
-    // Watchdog Interrupt Mode
-    wdt_intr_enable(wdto);
+        // Watchdog Interrupt Mode
+        wdt_intr_enable(wdto);
+    }
 
     // TODO: more power saving
     // See PicoPower application note
@@ -66,6 +74,12 @@ static void power_down(uint8_t wdto)
     sleep_cpu();
     sleep_disable();
 
+    if (key_intr) {
+        matrix_wakeup_disable();
+        key_wakeup = true;
+        return;
+    }
+
     // Disable watchdog after sleep
     wdt_disable();
 }
@@ -100,6 +114,11 @@ void suspend_idle(uint8_t time)
 
 void suspend_power_down(void)
 {
+#ifdef BOOTMAGIC_ENABLE
+    // settings in RAM would be lost if host cut power
+    eeconfig_commit();
+#endif
+
 #ifdef NO_SUSPEND_POWER_DOWN
     ;
 #elif defined(SUSPEND_MODE_NOPOWERSAVE)
@@ -115,6 +134,7 @@ void suspend_power_down(void)
 
 bool suspend_wakeup_condition(void)
 {
+    key_wakeup = false;
     matrix_power_up();
     matrix_scan();
     matrix_power_down();
@@ -1,7 +1,7 @@
 #include "ch.h"
 #include "hal.h"
 
-#include "eeconfig.h"
+#include "eeprom.h"
 
 /*************************************/
 /*          Hardware backend         */
@@ -51,7 +51,7 @@
 // (aligned to 2 or 4 byte boundaries) has twice the endurance
 // compared to writing 8 bit bytes.
 //
-#define EEPROM_SIZE 32
+// EEPROM_SIZE is 32, see eeprom.h
 
 // Writing unaligned 16 or 32 bit data is handled automatically when
 // this is defined, but at a cost of extra code size.  Without this,
@@ -313,7 +313,7 @@ void do_flash_cmd(volatile uint8_t *fstat)
 extern uint32_t __eeprom_workarea_start__;
 extern uint32_t __eeprom_workarea_end__;
 
-#define EEPROM_SIZE 128
+// EEPROM_SIZE is 128, see eeprom.h
 
 static uint32_t flashend = 0;
 
@@ -500,52 +500,73 @@ void eeprom_write_block(const void *buf, void *addr, uint32_t len)
 	}
 }
 
-#else
-#error EEPROM support not implemented for your chip
-#endif /* chip selection */
+#else /* chip selection */
+/* No EEPROM: settings are kept only in RAM until power off */
 
+static uint8_t buffer[EEPROM_SIZE];
 
-/*****************/
-/* TMK functions */
-/*****************/
+uint8_t eeprom_read_byte(const uint8_t *addr)
+{
+	uint32_t offset = (uint32_t)addr;
+	return (offset < EEPROM_SIZE) ? buffer[offset] : 0xFF;
+}
 
-void eeconfig_init(void)
+void eeprom_write_byte(uint8_t *addr, uint8_t value)
 {
-    eeprom_write_word(EECONFIG_MAGIC,          EECONFIG_MAGIC_NUMBER);
-    eeprom_write_byte(EECONFIG_DEBUG,          0);
-    eeprom_write_byte(EECONFIG_DEFAULT_LAYER,  0);
-    eeprom_write_byte(EECONFIG_KEYMAP,         0);
-    eeprom_write_byte(EECONFIG_MOUSEKEY_ACCEL, 0);
-#ifdef BACKLIGHT_ENABLE
-    eeprom_write_byte(EECONFIG_BACKLIGHT,      0);
-#endif
+	uint32_t offset = (uint32_t)addr;
+	if (offset < EEPROM_SIZE) buffer[offset] = value;
 }
 
-void eeconfig_enable(void)
+uint16_t eeprom_read_word(const uint16_t *addr)
 {
-    eeprom_write_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
+	const uint8_t *p = (const uint8_t *)addr;
+	return eeprom_read_byte(p) | (eeprom_read_byte(p+1) << 8);
 }
 
-void eeconfig_disable(void)
+uint32_t eeprom_read_dword(const uint32_t *addr)
 {
-    eeprom_write_word(EECONFIG_MAGIC, 0xFFFF);
+	const uint8_t *p = (const uint8_t *)addr;
+	return eeprom_read_byte(p) | (eeprom_read_byte(p+1) << 8)
+		| (eeprom_read_byte(p+2) << 16) | (eeprom_read_byte(p+3) << 24);
+}
+
+void eeprom_read_block(void *buf, const void *addr, uint32_t len)
+{
+	const uint8_t *p = (const uint8_t *)addr;
+	uint8_t *dest = (uint8_t *)buf;
+	while (len--) {
+		*dest++ = eeprom_read_byte(p++);
+	}
 }
 
-bool eeconfig_is_enabled(void)
+int eeprom_is_ready(void)
 {
-    return (eeprom_read_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER);
+	return 1;
 }
 
-uint8_t eeconfig_read_debug(void)      { return eeprom_read_byte(EECONFIG_DEBUG); }
-void eeconfig_write_debug(uint8_t val) { eeprom_write_byte(EECONFIG_DEBUG, val); }
+void eeprom_write_word(uint16_t *addr, uint16_t value)
+{
+	uint8_t *p = (uint8_t *)addr;
+	eeprom_write_byte(p++, value);
+	eeprom_write_byte(p, value >> 8);
+}
 
-uint8_t eeconfig_read_default_layer(void)      { return eeprom_read_byte(EECONFIG_DEFAULT_LAYER); }
-void eeconfig_write_default_layer(uint8_t val) { eeprom_write_byte(EECONFIG_DEFAULT_LAYER, val); }
+void eeprom_write_dword(uint32_t *addr, uint32_t value)
+{
+	uint8_t *p = (uint8_t *)addr;
+	eeprom_write_byte(p++, value);
+	eeprom_write_byte(p++, value >> 8);
+	eeprom_write_byte(p++, value >> 16);
+	eeprom_write_byte(p, value >> 24);
+}
 
-uint8_t eeconfig_read_keymap(void)      { return eeprom_read_byte(EECONFIG_KEYMAP); }
-void eeconfig_write_keymap(uint8_t val) { eeprom_write_byte(EECONFIG_KEYMAP, val); }
+void eeprom_write_block(const void *buf, void *addr, uint32_t len)
+{
+	uint8_t *p = (uint8_t *)addr;
+	const uint8_t *src = (const uint8_t *)buf;
+	while (len--) {
+		eeprom_write_byte(p++, *src++);
+	}
+}
+#endif /* chip selection */
 
-#ifdef BACKLIGHT_ENABLE
-uint8_t eeconfig_read_backlight(void)      { return eeprom_read_byte(EECONFIG_BACKLIGHT); }
-void eeconfig_write_backlight(uint8_t val) { eeprom_write_byte(EECONFIG_BACKLIGHT, val); }
-#endif
@@ -0,0 +1,26 @@
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include <stdint.h>
+
+/* EEPROM backend with avr-libc compatible API, see eeprom.c */
+#if defined(K20x)
+#   define EEPROM_SIZE  32      // FlexRAM
+#elif defined(KL2x)
+#   define EEPROM_SIZE  128     // emulated in flash
+#else
+#   define EEPROM_SIZE  32      // RAM only
+#endif
+
+void eeprom_initialize(void);
+uint8_t eeprom_read_byte(const uint8_t *addr);
+uint16_t eeprom_read_word(const uint16_t *addr);
+uint32_t eeprom_read_dword(const uint32_t *addr);
+void eeprom_read_block(void *buf, const void *addr, uint32_t len);
+int eeprom_is_ready(void);
+void eeprom_write_byte(uint8_t *addr, uint8_t value);
+void eeprom_write_word(uint16_t *addr, uint16_t value);
+void eeprom_write_dword(uint32_t *addr, uint32_t value);
+void eeprom_write_block(const void *buf, void *addr, uint32_t len);
+
+#endif
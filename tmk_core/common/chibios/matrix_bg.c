@@ -0,0 +1,103 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string.h>
+#include "ch.h"
+#include "hal.h"
+#include "matrix_bg.h"
+
+
+#define NO_SCAN     0xFF
+
+static matrix_row_t scan[2][MATRIX_ROWS];
+static uint8_t scan_fill = 0;           // buffer written in ISR
+static uint8_t scan_ready = NO_SCAN;    // buffer of latest complete scan
+static uint8_t scan_row = 0;
+
+/* Called in ISR, row is selected at previous step */
+static void step(void)
+{
+    scan[scan_fill][scan_row] = matrix_bg_read_cols();
+    matrix_bg_unselect_rows();
+    if (++scan_row == MATRIX_ROWS) {
+        scan_row = 0;
+        scan_ready = scan_fill;
+        scan_fill ^= 1;
+    }
+    matrix_bg_select_row(scan_row);
+}
+
+#ifdef MATRIX_BG_GPTD
+static void gpt_cb(GPTDriver *gptp)
+{
+    (void)gptp;
+    chSysLockFromISR();
+    step();
+    chSysUnlockFromISR();
+}
+
+static const GPTConfig gpt_config = {
+    .frequency = 1000000,
+    .callback = gpt_cb,
+};
+#else
+/* Virtual timer can't step faster than system tick; a tick longer than
+ * interval would make scan many times slower than busy wait. */
+#if (1000000 / CH_CFG_ST_FREQUENCY) > MATRIX_BG_INTERVAL
+#   error "MATRIX_BG: system tick is longer than MATRIX_BG_INTERVAL, define MATRIX_BG_GPTD."
+#endif
+#define VT_INTERVAL ((TIME_US2I(MATRIX_BG_INTERVAL) > 0) ? TIME_US2I(MATRIX_BG_INTERVAL) : 1)
+
+static virtual_timer_t vt;
+
+static void vt_cb(void *arg)
+{
+    (void)arg;
+    chSysLockFromISR();
+    step();
+    chVTSetI(&vt, VT_INTERVAL, vt_cb, NULL);
+    chSysUnlockFromISR();
+}
+#endif
+
+
+void matrix_bg_start(void)
+{
+    matrix_bg_unselect_rows();
+    matrix_bg_select_row(0);
+#ifdef MATRIX_BG_GPTD
+    gptStart(&MATRIX_BG_GPTD, &gpt_config);
+    gptStartContinuous(&MATRIX_BG_GPTD, MATRIX_BG_INTERVAL);
+#else
+    chVTObjectInit(&vt);
+    chVTSet(&vt, VT_INTERVAL, vt_cb, NULL);
+#endif
+}
+
+bool matrix_bg_read(matrix_row_t rows[MATRIX_ROWS])
+{
+    bool ready = false;
+
+    chSysLock();
+    if (scan_ready != NO_SCAN) {
+        memcpy(rows, scan[scan_ready], sizeof(scan[0]));
+        scan_ready = NO_SCAN;
+        ready = true;
+    }
+    chSysUnlock();
+    return ready;
+}
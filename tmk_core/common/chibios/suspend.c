@@ -10,6 +10,7 @@
 #include "host.h"
 #include "backlight.h"
 #include "suspend.h"
+#include "eeconfig.h"
 
 void suspend_idle(uint8_t time) {
 	// TODO: this is not used anywhere - what units is 'time' in?
@@ -17,6 +18,11 @@ void suspend_idle(uint8_t time) {
 }
 
 void suspend_power_down(void) {
+#ifdef BOOTMAGIC_ENABLE
+	// settings in RAM would be lost if host cut power
+	eeconfig_commit();
+#endif
+
 	// TODO: figure out what to power down and how
 	// shouldn't power down TPM/FTM if we want a breathing LED
 	// also shouldn't power down USB
@@ -33,6 +33,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "led.h"
 #include "command.h"
 #include "backlight.h"
+#include "profile.h"
+#include "latency.h"
+#include "trace.h"
 
 #ifdef MOUSEKEY_ENABLE
 #include "mousekey.h"
@@ -49,6 +52,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #   include "usbdrv.h"
 #endif
 
+#if defined(PROTOCOL_LUFA) && defined(CONSOLE_ENABLE)
+#   include "lufa.h"
+#endif
+
+#if defined(PROTOCOL_CHIBIOS) && defined(CONSOLE_ENABLE)
+#   include "usb_main.h"
+#endif
+
 
 static bool command_common(uint8_t code);
 static void command_common_help(void);
@@ -141,6 +152,18 @@ static void command_common_help(void)
 #ifdef SLEEP_LED_ENABLE
           "z:	sleep LED test\n"
 #endif
+
+#ifdef PROFILE_ENABLE
+          "p:	profile\n"
+#endif
+
+#ifdef LATENCY_ENABLE
+          "l:	key latency\n"
+#endif
+
+#ifdef TRACE_ENABLE
+          "t:	key trace\n"
+#endif
     );
 }
 
@@ -201,6 +224,27 @@ static bool command_common(uint8_t code)
             sleep_led_test = !sleep_led_test;
             break;
 #endif
+#ifdef PROFILE_ENABLE
+        case KC_P:
+            print("\n\t- Profile -\n");
+            profile_print();
+            profile_clear();
+            break;
+#endif
+#ifdef LATENCY_ENABLE
+        case KC_L:
+            print("\n\t- Latency -\n");
+            latency_print();
+            latency_clear();
+            break;
+#endif
+#ifdef TRACE_ENABLE
+        case KC_T:
+            print("\n\t- Trace -\n");
+            trace_print();
+            trace_clear();
+            break;
+#endif
 #ifdef BOOTMAGIC_ENABLE
         case KC_E:
             print("eeconfig:\n");
@@ -319,6 +363,15 @@ static bool command_common(uint8_t code)
 #endif
 #ifdef KEYMAP_SECTION_ENABLE
             " KEYMAP_SECTION"
+#endif
+#ifdef PROFILE_ENABLE
+            " PROFILE"
+#endif
+#ifdef LATENCY_ENABLE
+            " LATENCY"
+#endif
+#ifdef TRACE_ENABLE
+            " TRACE"
 #endif
             " " STR(BOOTLOADER_SIZE) "\n");
 
@@ -353,6 +406,14 @@ static bool command_common(uint8_t code)
 #   if USB_COUNT_SOF
             print_val_hex8(usbSofCount);
 #   endif
+#endif
+
+#if (defined(PROTOCOL_LUFA) || defined(PROTOCOL_CHIBIOS)) && defined(CONSOLE_ENABLE)
+            print_val_dec(console_dropped);
+#endif
+
+#ifdef SCAN_THREAD_ENABLE
+            keyboard_scan_print();
 #endif
             break;
 #ifdef NKRO_ENABLE
@@ -56,7 +56,36 @@ extern debug_config_t debug_config;
 /*
  * Debug print utils
  */
-#ifndef NO_DEBUG
+#if !defined(NO_DEBUG) && defined(TLOG_ENABLE)
+
+/* Tokenized log: debug print is recorded in binary and formatted on host */
+#include "tlog.h"
+
+#define dprint(s)                   do { if (debug_enable) tlog(s); } while (0)
+#define dprintln(s)                 do { if (debug_enable) tlog(s "\r\n"); } while (0)
+#define dprintf(fmt, ...)           do { if (debug_enable) tlog(fmt, ##__VA_ARGS__); } while (0)
+#define dmsg(s)                     dprintf("%S at %u: %S\n", PSTR(__FILE__), __LINE__, PSTR(s))
+
+#define debug(s)                    do { if (debug_enable) tlog(s); } while (0)
+#define debugln(s)                  do { if (debug_enable) tlog(s "\r\n"); } while (0)
+#define debug_msg(s)                dprintf("%S at %u: %S", PSTR(__FILE__), __LINE__, PSTR(s))
+#define debug_dec(data)             dprintf("%u", data)
+#define debug_decs(data)            dprintf("%d", data)
+#define debug_hex4(data)            dprintf("%X", data)
+#define debug_hex8(data)            dprintf("%02X", data)
+#define debug_hex16(data)           dprintf("%04X", data)
+#define debug_hex32(data)           dprintf("%08lX", data)
+#define debug_bin8(data)            dprintf("%08b", data)
+#define debug_bin16(data)           dprintf("%016b", data)
+#define debug_bin32(data)           dprintf("%032lb", data)
+#define debug_bin_reverse8(data)    dprintf("%08b", bitrev(data))
+#define debug_bin_reverse16(data)   dprintf("%016b", bitrev16(data))
+#define debug_bin_reverse32(data)   dprintf("%032lb", bitrev32(data))
+#define debug_hex(data)             debug_hex8(data)
+#define debug_bin(data)             debug_bin8(data)
+#define debug_bin_reverse(data)     debug_bin8(data)
+
+#elif !defined(NO_DEBUG)
 
 #define dprint(s)                   do { if (debug_enable) print(s); } while (0)
 #define dprintln(s)                 do { if (debug_enable) println(s); } while (0)
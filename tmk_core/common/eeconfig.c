@@ -0,0 +1,242 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+#include "eeconfig.h"
+#if defined(__AVR__)
+#   include <avr/eeprom.h>
+#else
+#   include "chibios/eeprom.h"
+#endif
+
+
+/*
+ * Journal of settings
+ *
+ * Every commit writes whole settings as a new entry into next slot of the
+ * circular log, so that wear is spread over all slots. Latest entry is the
+ * end of chain of valid entries whose sequence numbers increase by one.
+ * Entry is valid when it has ENTRY_TAG of this layout and its CRC matches.
+ * Entry with broken CRC, e.g. from power loss during write, is ignored and
+ * previous one is used.
+ *
+ * When magic of legacy layout is found the journal area, which may hold
+ * anything written by older firmware, is erased once and the legacy
+ * settings are migrated into it.
+ *
+ * On AVR an entry is written a byte per eeconfig_task call while EEPROM is
+ * ready, so that keyboard_task doesn't stall 3.3ms for each byte.
+ */
+typedef struct {
+    uint8_t seq;
+    uint8_t magic;
+    uint8_t debug;
+    uint8_t default_layer;
+    uint8_t keymap;
+    uint8_t backlight;
+    uint8_t tag;
+    uint8_t crc;
+} eeconfig_entry_t;
+
+#define ENTRY_MAGIC     0xEE    // eeconfig enabled
+#define ENTRY_TAG       0xC1    // entry layout version
+
+#if !defined(EECONFIG_JOURNAL_ADDR)
+/* after legacy layout */
+#   define EECONFIG_JOURNAL_ADDR    8
+#   define EECONFIG_JOURNAL_SIZE    ((EEPROM_SIZE - EECONFIG_JOURNAL_ADDR) & ~(sizeof(eeconfig_entry_t) - 1))
+#endif
+
+#define ENTRIES         (EECONFIG_JOURNAL_SIZE / sizeof(eeconfig_entry_t))
+#define ENTRY_ADDR(i)   ((uint8_t *)(EECONFIG_JOURNAL_ADDR + (i) * sizeof(eeconfig_entry_t)))
+
+static eeconfig_entry_t config;     // current settings
+static eeconfig_entry_t pending;    // entry being written
+static uint8_t slot;                // slot of latest entry
+static uint8_t write_pos = sizeof(pending);
+static bool loaded = false;
+static bool dirty = false;
+static uint16_t dirty_time = 0;
+
+
+static uint8_t crc8(const eeconfig_entry_t *e)
+{
+    const uint8_t *p = (const uint8_t *)e;
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < sizeof(*e) - 1; i++) {
+        crc ^= p[i];
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+        }
+    }
+    // erased entry(0xFF...) should not be valid
+    return crc ^ 0x55;
+}
+
+static bool read_entry(uint8_t i, eeconfig_entry_t *e)
+{
+    eeprom_read_block(e, ENTRY_ADDR(i), sizeof(*e));
+    return e->tag == ENTRY_TAG && e->crc == crc8(e);
+}
+
+/* erase journal and migrate settings from legacy layout */
+static void format(void)
+{
+    for (uint16_t i = 0; i < ENTRIES * sizeof(eeconfig_entry_t); i++) {
+        uint8_t *addr = ENTRY_ADDR(0) + i;
+        if (eeprom_read_byte(addr) != 0xFF) eeprom_write_byte(addr, 0xFF);
+    }
+
+    config = (eeconfig_entry_t){ .tag = ENTRY_TAG };
+    slot = ENTRIES - 1;
+    config.magic          = ENTRY_MAGIC;
+    config.debug          = eeprom_read_byte(EECONFIG_DEBUG);
+    config.default_layer  = eeprom_read_byte(EECONFIG_DEFAULT_LAYER);
+    config.keymap         = eeprom_read_byte(EECONFIG_KEYMAP);
+    config.backlight      = eeprom_read_byte(EECONFIG_BACKLIGHT);
+    dirty = true;
+
+    // only once
+    eeprom_write_word(EECONFIG_MAGIC, 0xFFFF);
+}
+
+static void load(void)
+{
+    if (loaded) return;
+    loaded = true;
+
+    if (eeprom_read_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER) {
+        format();
+        return;
+    }
+
+    eeconfig_entry_t e, next;
+    for (uint8_t i = 0; i < ENTRIES; i++) {
+        if (!read_entry(i, &e)) continue;
+
+        uint8_t n = (i + 1) % ENTRIES;
+        if (!read_entry(n, &next) || next.seq != (uint8_t)(e.seq + 1)) {
+            config = e;
+            slot = i;
+            return;
+        }
+    }
+
+    // no entry
+    config = (eeconfig_entry_t){ .tag = ENTRY_TAG };
+    slot = ENTRIES - 1;
+}
+
+static void begin_write(void)
+{
+    config.seq++;
+    pending = config;
+    pending.crc = crc8(&pending);
+    slot = (slot + 1) % ENTRIES;
+    write_pos = 0;
+    dirty = false;
+}
+
+/* Write pending entry. Returns true when done. */
+static bool write_entry(bool wait)
+{
+    while (write_pos < sizeof(pending)) {
+        if (!wait && !eeprom_is_ready()) return false;
+
+        uint8_t *addr = ENTRY_ADDR(slot) + write_pos;
+        uint8_t data = ((uint8_t *)&pending)[write_pos++];
+        if (eeprom_read_byte(addr) != data) {
+            eeprom_write_byte(addr, data);
+            if (!wait) return false;
+        }
+    }
+    return true;
+}
+
+static void update(uint8_t *field, uint8_t val)
+{
+    load();
+    if (*field == val) return;
+    *field = val;
+    dirty = true;
+    dirty_time = timer_read();
+}
+
+
+/* Called from keyboard_task */
+void eeconfig_task(void)
+{
+    if (!write_entry(false)) return;
+
+    if (dirty && timer_elapsed(dirty_time) > EECONFIG_COMMIT_DELAY) {
+        begin_write();
+        write_entry(false);
+    }
+}
+
+/* Write changes now, e.g. before suspend */
+void eeconfig_commit(void)
+{
+    write_entry(true);
+    if (dirty) {
+        begin_write();
+        write_entry(true);
+    }
+}
+
+void eeconfig_init(void)
+{
+    load();
+    uint8_t seq = config.seq;
+    config = (eeconfig_entry_t){ .seq = seq, .magic = ENTRY_MAGIC, .tag = ENTRY_TAG };
+    dirty = true;
+    eeconfig_commit();
+}
+
+void eeconfig_enable(void)
+{
+    update(&config.magic, ENTRY_MAGIC);
+    eeconfig_commit();
+}
+
+void eeconfig_disable(void)
+{
+    update(&config.magic, 0);
+    eeconfig_commit();
+}
+
+bool eeconfig_is_enabled(void)
+{
+    load();
+    return (config.magic == ENTRY_MAGIC);
+}
+
+uint8_t eeconfig_read_debug(void)      { load(); return config.debug; }
+void eeconfig_write_debug(uint8_t val) { update(&config.debug, val); }
+
+uint8_t eeconfig_read_default_layer(void)      { load(); return config.default_layer; }
+void eeconfig_write_default_layer(uint8_t val) { update(&config.default_layer, val); }
+
+uint8_t eeconfig_read_keymap(void)      { load(); return config.keymap; }
+void eeconfig_write_keymap(uint8_t val) { update(&config.keymap, val); }
+
+#ifdef BACKLIGHT_ENABLE
+uint8_t eeconfig_read_backlight(void)      { load(); return config.backlight; }
+void eeconfig_write_backlight(uint8_t val) { update(&config.backlight, val); }
+#endif
@@ -24,7 +24,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #define EECONFIG_MAGIC_NUMBER                       (uint16_t)0xFEED
 
-/* eeprom parameteter address */
+/* eeprom parameteter address of legacy layout, read once to migrate */
 #define EECONFIG_MAGIC                              (uint16_t *)0
 #define EECONFIG_DEBUG                              (uint8_t *)2
 #define EECONFIG_DEFAULT_LAYER                      (uint8_t *)3
@@ -32,6 +32,23 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define EECONFIG_MOUSEKEY_ACCEL                     (uint8_t *)5
 #define EECONFIG_BACKLIGHT                          (uint8_t *)6
 
+/*
+ * Settings are kept in RAM and committed lazily to a circular log in EEPROM,
+ * EECONFIG_COMMIT_DELAY after last change or before suspend. See eeconfig.c.
+ */
+#ifndef EECONFIG_COMMIT_DELAY
+#define EECONFIG_COMMIT_DELAY                       3000
+#endif
+
+/* log at end of EEPROM on AVR */
+#if defined(__AVR__)
+#   include <avr/io.h>
+#   ifndef EECONFIG_JOURNAL_SIZE
+#   define EECONFIG_JOURNAL_SIZE                    128
+#   endif
+#   define EECONFIG_JOURNAL_ADDR                    (E2END + 1 - EECONFIG_JOURNAL_SIZE)
+#endif
+
 
 /* debug bit */
 #define EECONFIG_DEBUG_ENABLE                       (1<<0)
@@ -58,6 +75,9 @@ void eeconfig_enable(void);
 
 void eeconfig_disable(void);
 
+void eeconfig_task(void);
+void eeconfig_commit(void);
+
 uint8_t eeconfig_read_debug(void);
 void eeconfig_write_debug(uint8_t val);
 
@@ -0,0 +1,373 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+#include "keyboard.h"
+#include "keycode.h"
+#include "timer.h"
+#include "eeconfig.h"
+#include "action_layer.h"
+#include "debug.h"
+#include "eekeymap.h"
+
+#ifndef __AVR__
+#   error "EEPROM keymap is supported only on AVR."
+#endif
+
+
+#define LAYER_SIZE      (MATRIX_ROWS * MATRIX_COLS)
+#define EE_MAGIC        ((uint16_t *)EEKEYMAP_ADDR)
+#define EE_VALID        ((uint8_t *)(EEKEYMAP_ADDR + 2))
+#define EE_LAYER(l)     ((uint8_t *)(EEKEYMAP_ADDR + 3) + (uint16_t)(l) * LAYER_SIZE)
+#define NO_SLOT         0xFF
+
+#if (EEKEYMAP_LAYERS > 8)
+#   error "EEKEYMAP_LAYERS should be 8 or less."
+#endif
+#if (EEKEYMAP_ADDR + 3 + EEKEYMAP_LAYERS * MATRIX_ROWS * MATRIX_COLS > EECONFIG_JOURNAL_ADDR)
+#   error "EEKEYMAP_LAYERS don't fit in EEPROM."
+#endif
+
+/* user keymaps should be defined somewhere, optionally with its size */
+extern const uint8_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
+/* Unknown size reads flash as keymap.c does for any layer. Keymap file may
+ * define it so that layers out of keymaps[] start as transparent:
+ *     const uint16_t keymaps_size = sizeof(keymaps);
+ */
+__attribute__ ((weak))
+const uint16_t keymaps_size = UINT16_MAX;
+
+/* layers valid in RAM and layers whose data is in EEPROM */
+uint8_t eekeymap_layers = 0;
+static uint8_t eeprom_layers = 0;
+
+/* cache of rewritten layers, active and being edited */
+static uint8_t cache[EEKEYMAP_CACHE][MATRIX_ROWS][MATRIX_COLS];
+static uint8_t slot_layer[EEKEYMAP_CACHE];
+static uint8_t layer_slot[EEKEYMAP_LAYERS];
+static uint8_t victim = 0;
+static uint8_t dirty = 0;       // bitmap of slots
+static uint16_t dirty_time = 0;
+static bool save_now = false;
+
+/* write back in progress, a byte per eekeymap_task */
+static uint8_t write_slot = NO_SLOT;
+static uint16_t write_pos = 0;
+static bool valid_pending = false;
+
+/* request from host */
+static uint8_t request[EEKEYMAP_REPORT_SIZE];
+static volatile bool request_pending = false;
+uint8_t eekeymap_response[EEKEYMAP_REPORT_SIZE];
+
+
+/* Keycode in flash keymap; layer out of keymaps[] is transparent */
+static uint8_t flash_keycode(uint8_t layer, uint8_t row, uint8_t col)
+{
+    if (layer >= keymaps_size / LAYER_SIZE) return KC_TRANSPARENT;
+    return pgm_read_byte(&keymaps[layer][row][col]);
+}
+
+/* bitmap of layers in use for lookup */
+static uint8_t active_layers(void)
+{
+    uint32_t state = default_layer_state ? default_layer_state : 1;
+#ifndef NO_ACTION_LAYER
+    state |= layer_state;
+#endif
+    return state & ((1<<EEKEYMAP_LAYERS) - 1);
+}
+
+/*
+ * Write back changes of slot. Returns true when done.
+ * Without wait only one byte is written per call and it returns while
+ * EEPROM is busy, like journal of eeconfig.
+ */
+static bool write_layer(bool wait)
+{
+    if (write_slot == NO_SLOT) return true;
+
+    uint8_t layer = slot_layer[write_slot];
+    while (write_pos < LAYER_SIZE) {
+        if (!wait && !eeprom_is_ready()) return false;
+
+        uint8_t *addr = EE_LAYER(layer) + write_pos;
+        uint8_t data = ((uint8_t *)cache[write_slot])[write_pos++];
+        if (eeprom_read_byte(addr) != data) {
+            eeprom_write_byte(addr, data);
+            if (!wait) return false;
+        }
+    }
+    // mark valid after data is written
+    eeprom_layers |= (1<<layer);
+    valid_pending = true;
+    write_slot = NO_SLOT;
+    return true;
+}
+
+static bool write_valid(bool wait)
+{
+    if (!valid_pending) return true;
+    if (!wait && !eeprom_is_ready()) return false;
+    if (eeprom_read_byte(EE_VALID) != eeprom_layers) {
+        eeprom_write_byte(EE_VALID, eeprom_layers);
+    }
+    valid_pending = false;
+    return true;
+}
+
+static void begin_write(void)
+{
+    for (uint8_t i = 0; i < EEKEYMAP_CACHE; i++) {
+        if (dirty & (1<<i)) {
+            // changes made while writing mark it dirty again
+            dirty &= ~(1<<i);
+            write_slot = i;
+            write_pos = 0;
+            return;
+        }
+    }
+}
+
+/*
+ * Load layer into cache. Layer not written yet is copied from flash.
+ * Slot being written, dirty or of active layer is not evicted and EEPROM
+ * is read only when it is ready, otherwise returns NO_SLOT.
+ */
+static uint8_t load(uint8_t layer)
+{
+    if ((eeprom_layers & (1<<layer)) && !eeprom_is_ready()) return NO_SLOT;
+
+    uint8_t slot = NO_SLOT;
+    for (uint8_t n = 0; n < EEKEYMAP_CACHE; n++) {
+        uint8_t i = victim;
+        victim = (victim + 1) % EEKEYMAP_CACHE;
+        if (i == write_slot || (dirty & (1<<i))) continue;
+        if (slot_layer[i] != NO_SLOT && (active_layers() & (1<<slot_layer[i]))) continue;
+        slot = i;
+        break;
+    }
+    if (slot == NO_SLOT) return NO_SLOT;
+
+    if (slot_layer[slot] != NO_SLOT) {
+        layer_slot[slot_layer[slot]] = NO_SLOT;
+    }
+    if (eeprom_layers & (1<<layer)) {
+        eeprom_read_block(cache[slot], EE_LAYER(layer), LAYER_SIZE);
+    } else if (layer < keymaps_size / LAYER_SIZE) {
+        memcpy_P(cache[slot], keymaps[layer], LAYER_SIZE);
+    } else {
+        memset(cache[slot], KC_TRANSPARENT, LAYER_SIZE);
+    }
+    slot_layer[slot] = layer;
+    layer_slot[layer] = slot;
+    return slot;
+}
+
+/* Keep active rewritten layers in cache for lookup */
+static void cache_active(void)
+{
+    uint8_t layers = active_layers() & eeprom_layers;
+    for (uint8_t i = 0; i < EEKEYMAP_LAYERS; i++) {
+        if (!(layers & (1<<i)) || layer_slot[i] != NO_SLOT) continue;
+        if (load(i) == NO_SLOT) return;
+    }
+}
+
+void eekeymap_init(void)
+{
+    for (uint8_t i = 0; i < EEKEYMAP_CACHE; i++) slot_layer[i] = NO_SLOT;
+    for (uint8_t i = 0; i < EEKEYMAP_LAYERS; i++) layer_slot[i] = NO_SLOT;
+
+    if (eeprom_read_word(EE_MAGIC) != EEKEYMAP_MAGIC_NUMBER) {
+        eeprom_update_byte(EE_VALID, 0);
+        eeprom_update_word(EE_MAGIC, EEKEYMAP_MAGIC_NUMBER);
+    }
+    eeprom_layers = eeprom_read_byte(EE_VALID) & ((1<<EEKEYMAP_LAYERS) - 1);
+    eekeymap_layers = eeprom_layers;
+    cache_active();
+}
+
+/*
+ * Layer must be valid, see eekeymap_layers.
+ * Active layers are in cache unless more than EEKEYMAP_CACHE are rewritten
+ * or eekeymap_task hasn't run since layer switch. Then EEPROM is read only
+ * when it is ready and flash keymap is used while EEPROM is busy writing,
+ * so that lookup never waits for EEPROM.
+ */
+uint8_t eekeymap_key_to_keycode(uint8_t layer, keypos_t key)
+{
+    uint8_t slot = layer_slot[layer];
+    if (slot != NO_SLOT) {
+        return cache[slot][key.row][key.col];
+    }
+    if ((eeprom_layers & (1<<layer)) && eeprom_is_ready()) {
+        return eeprom_read_byte(EE_LAYER(layer) + key.row * MATRIX_COLS + key.col);
+    }
+    return flash_keycode(layer, key.row, key.col);
+}
+
+/* Returns false when layer can't be cached now, try again later */
+bool eekeymap_set_keycode(uint8_t layer, keypos_t key, uint8_t keycode)
+{
+    if (layer >= EEKEYMAP_LAYERS || key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {
+        return false;
+    }
+
+    uint8_t slot = layer_slot[layer];
+    if (slot == NO_SLOT) {
+        slot = load(layer);
+        if (slot == NO_SLOT) return false;
+    }
+    if (cache[slot][key.row][key.col] != keycode) {
+        cache[slot][key.row][key.col] = keycode;
+        dirty |= (1<<slot);
+        dirty_time = timer_read();
+    }
+    eekeymap_layers |= (1<<layer);
+    return true;
+}
+
+void eekeymap_reset_layer(uint8_t layer)
+{
+    if (layer >= EEKEYMAP_LAYERS) return;
+
+    uint8_t slot = layer_slot[layer];
+    if (slot != NO_SLOT) {
+        if (write_slot == slot) write_slot = NO_SLOT;
+        dirty &= ~(1<<slot);
+        slot_layer[slot] = NO_SLOT;
+        layer_slot[layer] = NO_SLOT;
+    }
+    eekeymap_layers &= ~(1<<layer);
+    eeprom_layers &= ~(1<<layer);
+    valid_pending = true;
+}
+
+/* Write all changes now and wait, e.g. before jumping to bootloader */
+void eekeymap_save(void)
+{
+    do {
+        write_layer(true);
+        begin_write();
+    } while (write_slot != NO_SLOT);
+    write_valid(true);
+}
+
+
+/*
+ * Host request
+ */
+bool eekeymap_request(const uint8_t *data, uint8_t len)
+{
+    if (request_pending) return false;
+
+    if (len > EEKEYMAP_REPORT_SIZE) len = EEKEYMAP_REPORT_SIZE;
+    memset(request, 0, sizeof(request));
+    memcpy(request, data, len);
+    eekeymap_response[0] = request[0];
+    eekeymap_response[1] = EEKEYMAP_BUSY;
+    request_pending = true;
+    return true;
+}
+
+static uint8_t process_request(void)
+{
+    uint8_t layer = request[1];
+    uint8_t row = request[2];
+    uint8_t col = request[3];
+    uint8_t n = request[4];
+    uint8_t *res = &eekeymap_response[2];
+
+    switch (request[0]) {
+        case EEKEYMAP_GET_INFO:
+            res[0] = MATRIX_ROWS;
+            res[1] = MATRIX_COLS;
+            res[2] = EEKEYMAP_LAYERS;
+            res[3] = eekeymap_layers;
+            return EEKEYMAP_OK;
+        case EEKEYMAP_GET_KEYS:
+        case EEKEYMAP_SET_KEYS:
+            if (layer >= EEKEYMAP_LAYERS || row >= MATRIX_ROWS || col >= MATRIX_COLS ||
+                    n > EEKEYMAP_REPORT_SIZE - 5 ||
+                    row * MATRIX_COLS + col + n > LAYER_SIZE) {
+                return EEKEYMAP_INVALID;
+            }
+            // layer not cached needs EEPROM or a free slot
+            if (layer_slot[layer] == NO_SLOT) {
+                if (request[0] == EEKEYMAP_SET_KEYS) {
+                    if (load(layer) == NO_SLOT) return EEKEYMAP_BUSY;
+                } else if ((eeprom_layers & (1<<layer)) && !eeprom_is_ready()) {
+                    return EEKEYMAP_BUSY;
+                }
+            }
+            // keys are in row-major order from (row, col)
+            for (uint8_t i = 0; i < n; i++) {
+                keypos_t key = (keypos_t){ .row = row, .col = col };
+                if (request[0] == EEKEYMAP_GET_KEYS) {
+                    res[i] = (eekeymap_layers & (1<<layer)) ?
+                             eekeymap_key_to_keycode(layer, key) :
+                             flash_keycode(layer, row, col);
+                } else {
+                    eekeymap_set_keycode(layer, key, request[5 + i]);
+                }
+                if (++col == MATRIX_COLS) { col = 0; row++; }
+            }
+            return EEKEYMAP_OK;
+        case EEKEYMAP_RESET_LAYER:
+            if (layer >= EEKEYMAP_LAYERS) return EEKEYMAP_INVALID;
+            eekeymap_reset_layer(layer);
+            return EEKEYMAP_OK;
+        case EEKEYMAP_SAVE:
+            // written by eekeymap_task without waiting
+            save_now = true;
+            return EEKEYMAP_OK;
+        default:
+            return EEKEYMAP_INVALID;
+    }
+}
+
+/* Called from keyboard_task, never waits for EEPROM */
+void eekeymap_task(void)
+{
+    if (request_pending) {
+        memset(&eekeymap_response[2], 0, EEKEYMAP_REPORT_SIZE - 2);
+        uint8_t status = process_request();
+        // layer can't be cached now; retry on next call while host polls
+        if (status != EEKEYMAP_BUSY) {
+            dprintf("eekeymap: %02X %u\n", request[0], status);
+            // status last: host polls until it's not busy
+            eekeymap_response[1] = status;
+            request_pending = false;
+        }
+    }
+
+    if (write_layer(false) && write_valid(false)) {
+        if (dirty && (save_now || timer_elapsed(dirty_time) > EEKEYMAP_WRITE_DELAY)) {
+            begin_write();
+            write_layer(false);
+        } else if (!dirty) {
+            save_now = false;
+        }
+    }
+
+    cache_active();
+}
@@ -0,0 +1,111 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef EEKEYMAP_H
+#define EEKEYMAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "keyboard.h"
+
+
+/*
+ * Keymap in EEPROM
+ *
+ * Layers of keymap can be rewritten at runtime and are stored in EEPROM.
+ * A layer not written yet is read from keymaps[] in flash as before. This
+ * works on plain keymap path(keymaps[] of keycodes) only, not on unimap or
+ * actionmap. Rewritten layers which are active and ones being edited are
+ * cached in RAM, so lookup reads RAM and never waits for EEPROM. Changes are
+ * written back after EEKEYMAP_WRITE_DELAY, a byte per eekeymap_task and only
+ * bytes changed, so keyboard_task is not blocked by EEPROM write.
+ *
+ * Keymap file can define size of keymaps[] in bytes, then layers out of
+ * keymaps[] start as transparent instead of reading flash after it:
+ *     const uint16_t keymaps_size = sizeof(keymaps);
+ *
+ * Requests are received as HID feature report of console interface and
+ * processed in eekeymap_task. Response is read with GetReport(Feature).
+ * See tool/eekeymap.py.
+ *
+ * EEPROM layout from EEKEYMAP_ADDR:
+ *     magic(2), valid layers bitmap(1), layers[EEKEYMAP_LAYERS][ROWS][COLS]
+ */
+
+/* start of keymap in EEPROM, between legacy eeconfig and its journal */
+#ifndef EEKEYMAP_ADDR
+#define EEKEYMAP_ADDR           32
+#endif
+
+/* number of layers which can be rewritten, up to 8 */
+#ifndef EEKEYMAP_LAYERS
+#define EEKEYMAP_LAYERS         4
+#endif
+
+/* number of layers cached in RAM, active and being edited */
+#ifndef EEKEYMAP_CACHE
+#define EEKEYMAP_CACHE          2
+#endif
+
+/* ms from last change until written to EEPROM */
+#ifndef EEKEYMAP_WRITE_DELAY
+#define EEKEYMAP_WRITE_DELAY    1000
+#endif
+
+#define EEKEYMAP_MAGIC_NUMBER   0xEE4B
+#define EEKEYMAP_REPORT_SIZE    32
+
+/* Request: command, arguments */
+enum eekeymap_command {
+    EEKEYMAP_GET_INFO = 1,      // -> rows, cols, layers, valid layers
+    EEKEYMAP_GET_KEYS,          // layer, row, col, n -> keycodes[n]
+    EEKEYMAP_SET_KEYS,          // layer, row, col, n, keycodes[n]
+    EEKEYMAP_RESET_LAYER,       // layer: back to keymap in flash
+    EEKEYMAP_SAVE,              // write changes to EEPROM now
+};
+
+/* Response: command, status, data */
+enum eekeymap_status {
+    EEKEYMAP_OK = 0,
+    EEKEYMAP_BUSY,
+    EEKEYMAP_INVALID,
+};
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* bitmap of layers to read from EEPROM */
+extern uint8_t eekeymap_layers;
+extern uint8_t eekeymap_response[EEKEYMAP_REPORT_SIZE];
+
+void eekeymap_init(void);
+void eekeymap_task(void);
+uint8_t eekeymap_key_to_keycode(uint8_t layer, keypos_t key);
+bool eekeymap_set_keycode(uint8_t layer, keypos_t key, uint8_t keycode);
+void eekeymap_reset_layer(uint8_t layer);
+void eekeymap_save(void);
+
+/* from protocol driver, possibly in ISR */
+bool eekeymap_request(const uint8_t *data, uint8_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,77 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+#include "ghost.h"
+
+#ifdef MATRIX_HAS_GHOST
+
+#if (MATRIX_ROWS > 255 || MATRIX_COLS > 32)
+#   error "Matrix is too large for ghost detection."
+#endif
+
+#ifdef MATRIX_DIODE_MAP
+static const matrix_row_t diode_map[MATRIX_ROWS] = MATRIX_DIODE_MAP;
+#   define NO_DIODE(row, mask)  (!(diode_map[row] & (mask)))
+#else
+#   define NO_DIODE(row, mask)  true
+#endif
+
+static matrix_row_t matrix_read[MATRIX_ROWS];
+static uint8_t row_count[MATRIX_ROWS];
+static uint8_t col_count[MATRIX_COLS];
+/* keys without diode */
+static uint8_t row_nd[MATRIX_ROWS];
+static uint8_t col_nd[MATRIX_COLS];
+static uint16_t total_nd = 0;
+
+
+bool ghost_update(uint8_t row, matrix_row_t now)
+{
+    matrix_row_t change = now ^ matrix_read[row];
+    if (!change) return false;
+
+    matrix_row_t mask = 1;
+    for (uint8_t c = 0; c < MATRIX_COLS; c++, mask <<= 1) {
+        if (!(change & mask)) continue;
+
+        int8_t d = (now & mask) ? 1 : -1;
+        row_count[row] += d;
+        col_count[c] += d;
+        if (NO_DIODE(row, mask)) {
+            row_nd[row] += d;
+            col_nd[c] += d;
+            total_nd += d;
+        }
+    }
+    matrix_read[row] = now;
+    return true;
+}
+
+bool ghost_is_ambiguous(uint8_t row, uint8_t col)
+{
+    if (row_count[row] < 2 || col_count[col] < 2) return false;
+
+    // keys without diode out of the row and column, the key is subtracted twice
+    uint16_t diagonal = total_nd - row_nd[row] - col_nd[col];
+    if (NO_DIODE(row, (matrix_row_t)1<<col)) diagonal++;
+    return diagonal > 0;
+}
+
+#endif
@@ -0,0 +1,58 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GHOST_H
+#define GHOST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+
+
+/*
+ * Ghost detection(MATRIX_HAS_GHOST)
+ *
+ * Without diode a key conducts backward and three keys at corners of a
+ * rectangle make the fourth look pressed. A key down is ambiguous when its
+ * row and column have other keys down and a key without diode is down out
+ * of its row and column, the possible diagonal corner. Counts of keys down
+ * per row and column are kept from changes, so the check costs the same for
+ * any matrix size.
+ *
+ * Keys with diode are given per row in config.h(bit 1: has diode):
+ *     #define MATRIX_DIODE_MAP { 0x0000, 0x3FFF, ... }
+ * Without it no key has diode.
+ */
+
+#ifdef MATRIX_HAS_GHOST
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Updates counts with row read. Returns true if row is changed. */
+bool ghost_update(uint8_t row, matrix_row_t now);
+/* Returns true if key down can be ghost */
+bool ghost_is_ambiguous(uint8_t row, uint8_t col);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+#endif
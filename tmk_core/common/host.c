@@ -16,11 +16,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <stdint.h>
+#include <stdbool.h>
 //#include <avr/interrupt.h>
 #include "keycode.h"
 #include "host.h"
 #include "util.h"
 #include "debug.h"
+#include "profile.h"
+#include "powersave.h"
 
 
 #ifdef NKRO_ENABLE
@@ -51,7 +54,9 @@ uint8_t host_keyboard_leds(void)
 void host_keyboard_send(report_keyboard_t *report)
 {
     if (!driver) return;
+    PROFILE_BEGIN(HOST_SEND);
     (*driver->send_keyboard)(report);
+    PROFILE_END(HOST_SEND);
 
     if (debug_keyboard) {
         dprint("keyboard: ");
@@ -64,10 +69,106 @@ void host_keyboard_send(report_keyboard_t *report)
 
 void host_mouse_send(report_mouse_t *report)
 {
+    // mouse in use keeps keyboard_task at full rate
+    powersave_activity();
+
     if (!driver) return;
     (*driver->send_mouse)(report);
 }
 
+#ifdef MOUSE_ENABLE
+/*
+ * Mouse report accumulator
+ *
+ * Sources add motion and button state with host_mouse_add and one merged
+ * report is sent by host_mouse_task when mouse endpoint is ready, so that
+ * motion is not lost while endpoint is busy. Buttons of sources are ORed.
+ * Motion beyond -127..127 is carried over to next report.
+ *
+ * On button change, motion before it is queued as its own report to keep
+ * order of clicks and movement; the queue is sent first. It holds one
+ * report, so with the queue full a further change is merged into pending
+ * state and a click shorter than endpoint busy time can be lost.
+ */
+static uint8_t mouse_buttons[MOUSE_SOURCE_COUNT];
+static int16_t mouse_x, mouse_y, mouse_v, mouse_h;
+static bool mouse_changed = false;
+static report_mouse_t mouse_queue;
+static bool mouse_queued = false;
+
+static void mouse_sum(int16_t *acc, int8_t d)
+{
+    if (d > 0 && *acc > INT16_MAX - d) *acc = INT16_MAX;
+    else if (d < 0 && *acc < INT16_MIN - d) *acc = INT16_MIN;
+    else *acc += d;
+}
+
+static int8_t mouse_take(int16_t *acc)
+{
+    int8_t d = (*acc > 127) ? 127 : (*acc < -127) ? -127 : *acc;
+    *acc -= d;
+    return d;
+}
+
+static bool mouse_pending(void)
+{
+    return mouse_changed || mouse_x || mouse_y || mouse_v || mouse_h;
+}
+
+static void mouse_report(report_mouse_t *report)
+{
+    report->buttons = 0;
+    for (uint8_t i = 0; i < MOUSE_SOURCE_COUNT; i++) {
+        report->buttons |= mouse_buttons[i];
+    }
+    report->x = mouse_take(&mouse_x);
+    report->y = mouse_take(&mouse_y);
+    report->v = mouse_take(&mouse_v);
+    report->h = mouse_take(&mouse_h);
+    mouse_changed = false;
+}
+
+void host_mouse_add(uint8_t source, const report_mouse_t *report)
+{
+    if (source >= MOUSE_SOURCE_COUNT) return;
+
+    if (report->buttons != mouse_buttons[source]) {
+        if (!mouse_queued && mouse_pending()) {
+            mouse_report(&mouse_queue);
+            mouse_queued = true;
+        }
+        mouse_buttons[source] = report->buttons;
+        mouse_changed = true;
+    }
+    mouse_sum(&mouse_x, report->x);
+    mouse_sum(&mouse_y, report->y);
+    mouse_sum(&mouse_v, report->v);
+    mouse_sum(&mouse_h, report->h);
+}
+
+/* Called from keyboard_task */
+void host_mouse_task(void)
+{
+    if (!(mouse_queued || mouse_pending()) || !host_mouse_ready()) return;
+
+    if (mouse_queued) {
+        mouse_queued = false;
+        host_mouse_send(&mouse_queue);
+    } else {
+        report_mouse_t report;
+        mouse_report(&report);
+        host_mouse_send(&report);
+    }
+}
+
+/* driver without the check waits in send_mouse as before */
+__attribute__ ((weak))
+bool host_mouse_ready(void)
+{
+    return true;
+}
+#endif
+
 void host_system_send(uint16_t report)
 {
     if (report == last_system_report) return;
@@ -50,6 +50,21 @@ void host_consumer_send(uint16_t data);
 uint16_t host_last_system_report(void);
 uint16_t host_last_consumer_report(void);
 
+/* mouse sources merged into a report */
+enum mouse_source {
+    MOUSE_SOURCE_MOUSEKEY,
+    MOUSE_SOURCE_PS2,
+    MOUSE_SOURCE_SERIAL,
+    MOUSE_SOURCE_ADB,
+    MOUSE_SOURCE_COUNT
+};
+
+/* add motion and button state of source, sent by host_mouse_task */
+void host_mouse_add(uint8_t source, const report_mouse_t *report);
+void host_mouse_task(void);
+/* true when driver can send mouse report without waiting */
+bool host_mouse_ready(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -31,6 +31,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "eeconfig.h"
 #include "backlight.h"
 #include "hook.h"
+#include "ghost.h"
 #ifdef MOUSEKEY_ENABLE
 #   include "mousekey.h"
 #endif
@@ -43,23 +44,19 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef ADB_MOUSE_ENABLE
 #include "adb.h"
 #endif
-
-
-#ifdef MATRIX_HAS_GHOST
-static bool has_ghost_in_row(uint8_t row)
-{
-    matrix_row_t matrix_row = matrix_get_row(row);
-    // No ghost exists when less than 2 keys are down on the row
-    if (((matrix_row - 1) & matrix_row) == 0)
-        return false;
-
-    // Ghost occurs when the row shares column line with other row
-    for (uint8_t i=0; i < MATRIX_ROWS; i++) {
-        if (i != row && (matrix_get_row(i) & matrix_row))
-            return true;
-    }
-    return false;
-}
+#ifdef TLOG_ENABLE
+#include "tlog.h"
+#endif
+#include "profile.h"
+#include "trace.h"
+#ifdef EEKEYMAP_ENABLE
+#include "eekeymap.h"
+#endif
+#ifdef SOF_SYNC_ENABLE
+#include "sof_sync.h"
+#endif
+#ifdef POWERSAVE_ENABLE
+#include "powersave.h"
 #endif
 
 
@@ -71,6 +68,7 @@ void keyboard_setup(void)
 void keyboard_init(void)
 {
     timer_init();
+    profile_init();
     matrix_init();
 #ifdef PS2_MOUSE_ENABLE
     ps2_mouse_init();
@@ -87,55 +85,68 @@ void keyboard_init(void)
     bootmagic();
 #endif
 
+#ifdef EEKEYMAP_ENABLE
+    eekeymap_init();
+#endif
+
 #ifdef BACKLIGHT_ENABLE
     backlight_init();
 #endif
 }
 
-/*
- * Do keyboard routine jobs: scan matrix, light LEDs, ...
- * This is repeatedly called as fast as possible.
+/* Passes key changes of matrix to handler, returns true if matrix changed
+ *
+ * This doesn't print anything since it can run in scan thread(ChibiOS).
  */
-void keyboard_task(void)
+static bool matrix_events(void (*handler)(keyevent_t))
 {
     static matrix_row_t matrix_prev[MATRIX_ROWS];
-#ifdef MATRIX_HAS_GHOST
-    static matrix_row_t matrix_ghost[MATRIX_ROWS];
-#endif
-    static uint8_t led_status = 0;
     matrix_row_t matrix_row = 0;
     matrix_row_t matrix_change = 0;
+    bool changed = false;
 
-    matrix_scan();
+#ifdef MATRIX_HAS_GHOST
+    /* rows with a press held back, whose read can go back to matrix_prev */
+    static uint8_t ghost_held[(MATRIX_ROWS + 7) / 8];
+    uint8_t rows[MATRIX_ROWS];
+    uint8_t n = 0;
+
+    // counts of ghost detection are updated with all changed rows first
     for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        matrix_row = matrix_get_row(r);
+        if (matrix_row == matrix_prev[r] && !(ghost_held[r / 8] & (1 << (r % 8)))) continue;
+        // held back press doesn't count as change until ghost state changes
+        changed |= ghost_update(r, matrix_row);
+        rows[n++] = r;
+    }
+
+    for (uint8_t i = 0; i < n; i++) {
+        uint8_t r = rows[i];
+#else
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+#endif
         matrix_row = matrix_get_row(r);
         matrix_change = matrix_row ^ matrix_prev[r];
         if (matrix_change) {
-#ifdef MATRIX_HAS_GHOST
-            if (has_ghost_in_row(r)) {
-                /* Keep track of whether ghosted status has changed for
-                 * debugging. But don't update matrix_prev until un-ghosted, or
-                 * the last key would be lost.
-                 */
-                if (debug_matrix && matrix_ghost[r] != matrix_row) {
-                    matrix_print();
-                }
-                matrix_ghost[r] = matrix_row;
-                continue;
-            }
-            matrix_ghost[r] = matrix_row;
-#endif
-            if (debug_matrix) matrix_print();
             matrix_row_t col_mask = 1;
             for (uint8_t c = 0; c < MATRIX_COLS; c++, col_mask <<= 1) {
                 if (matrix_change & col_mask) {
+#ifdef MATRIX_HAS_GHOST
+                    /* Press of key which can be ghost is held back until it
+                     * is clear. Release is always real, and other keys of
+                     * the row are not affected.
+                     */
+                    if ((matrix_row & col_mask) && ghost_is_ambiguous(r, c)) {
+                        continue;
+                    }
+#endif
                     keyevent_t e = (keyevent_t){
                         .key = (keypos_t){ .row = r, .col = c },
                         .pressed = (matrix_row & col_mask),
                         .time = (timer_read() | 1) /* time should not be 0 */
                     };
-                    action_exec(e);
-                    hook_matrix_change(e);
+                    handler(e);
+                    changed = true;
                     // record a processed key
                     matrix_prev[r] ^= col_mask;
 
@@ -145,6 +156,73 @@ void keyboard_task(void)
                 }
             }
         }
+#ifdef MATRIX_HAS_GHOST
+        if (matrix_prev[r] != matrix_row) {
+            ghost_held[r / 8] |= (1 << (r % 8));
+        } else {
+            ghost_held[r / 8] &= ~(1 << (r % 8));
+        }
+#endif
+    }
+    return changed;
+}
+
+static void process_event(keyevent_t e)
+{
+    trace_event(e);
+    action_exec(e);
+    hook_matrix_change(e);
+}
+
+#ifdef SCAN_THREAD_ENABLE
+/*
+ * Scans matrix and posts key changes, called repeatedly in scan thread.
+ * keyboard_task processes them with keyboard_scan_fetch and prints matrix,
+ * console and tlog are used only in main thread.
+ */
+void keyboard_scan(void (*post)(keyevent_t))
+{
+    matrix_scan();
+    profile_scan();
+    matrix_events(post);
+}
+#endif
+
+/*
+ * Do keyboard routine jobs: scan matrix, light LEDs, ...
+ * This is repeatedly called as fast as possible.
+ */
+void keyboard_task(void)
+{
+    static uint8_t led_status = 0;
+
+    bool scan = true;
+#ifdef POWERSAVE_ENABLE
+    // scan at reduced rate while no key is used
+    scan = powersave_ready();
+#endif
+#ifdef SOF_SYNC_ENABLE
+    // hold scan back for slot before host polls keyboard
+    if (scan) scan = sof_sync_ready();
+#endif
+
+    PROFILE_BEGIN(KEYBOARD_TASK);
+    if (scan) {
+#ifdef SCAN_THREAD_ENABLE
+        keyevent_t e;
+        bool changed = false;
+        while (keyboard_scan_fetch(&e)) {
+            changed = true;
+            process_event(e);
+        }
+        if (debug_matrix && changed) matrix_print();
+#else
+        PROFILE_BEGIN(MATRIX_SCAN);
+        matrix_scan();
+        PROFILE_END(MATRIX_SCAN);
+        profile_scan();
+        if (matrix_events(process_event) && debug_matrix) matrix_print();
+#endif
     }
     // call with pseudo tick event when no real key event.
     action_exec(TICK);
@@ -155,11 +233,15 @@ void keyboard_task(void)
 
 #ifdef MOUSEKEY_ENABLE
     // mousekey repeat & acceleration
+    PROFILE_BEGIN(MOUSEKEY);
     mousekey_task();
+    PROFILE_END(MOUSEKEY);
 #endif
 
 #ifdef PS2_MOUSE_ENABLE
+    PROFILE_BEGIN(PS2_MOUSE);
     ps2_mouse_task();
+    PROFILE_END(PS2_MOUSE);
 #endif
 
 #ifdef SERIAL_MOUSE_ENABLE
@@ -170,12 +252,36 @@ void keyboard_task(void)
         adb_mouse_task();
 #endif
 
+#ifdef MOUSE_ENABLE
+    host_mouse_task();
+#endif
+
+#ifdef TLOG_ENABLE
+    tlog_task();
+#endif
+
+#ifdef EEKEYMAP_ENABLE
+    eekeymap_task();
+#endif
+
+#ifdef BOOTMAGIC_ENABLE
+    eeconfig_task();
+#endif
+
     // update LED
     if (led_status != host_keyboard_leds()) {
         led_status = host_keyboard_leds();
         if (debug_keyboard) dprintf("LED: %02X\n", led_status);
         hook_keyboard_leds_change(led_status);
     }
+
+    PROFILE_END(KEYBOARD_TASK);
+#ifdef SOF_SYNC_ENABLE
+    if (scan) sof_sync_scanned();
+#endif
+#ifdef POWERSAVE_ENABLE
+    if (scan) powersave_scanned(); else powersave_idle();
+#endif
 }
 
 void keyboard_set_leds(uint8_t leds)
@@ -67,6 +67,15 @@ void keyboard_task(void);
 /* it runs when host LED status is updated */
 void keyboard_set_leds(uint8_t leds);
 
+#ifdef SCAN_THREAD_ENABLE
+/* it runs repeatedly in scan thread and posts key changes(ChibiOS) */
+void keyboard_scan(void (*post)(keyevent_t));
+/* keyboard_task takes key changes posted by scan thread */
+bool keyboard_scan_fetch(keyevent_t *event);
+/* prints stack usage of threads */
+void keyboard_scan_print(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
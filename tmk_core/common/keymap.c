@@ -23,6 +23,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "wait.h"
 #include "debug.h"
 #include "bootloader.h"
+#ifdef EEKEYMAP_ENABLE
+#include "eekeymap.h"
+#endif
 #if defined(__AVR__)
 #include <avr/pgmspace.h>
 #endif
@@ -230,6 +233,11 @@ extern const action_t fn_actions[];
 __attribute__ ((weak))
 uint8_t keymap_key_to_keycode(uint8_t layer, keypos_t key)
 {
+#ifdef EEKEYMAP_ENABLE
+    if (layer < EEKEYMAP_LAYERS && (eekeymap_layers & (1<<layer))) {
+        return eekeymap_key_to_keycode(layer, key);
+    }
+#endif
 #if defined(__AVR__)
     return pgm_read_byte(&keymaps[(layer)][(key.row)][(key.col)]);
 #else
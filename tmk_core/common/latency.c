@@ -0,0 +1,169 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "keyboard.h"
+#include "timer.h"
+#include "print.h"
+#include "latency.h"
+
+#ifdef PROTOCOL_CHIBIOS
+#   include "ch.h"
+/* timer_read() can't be used in ISR on ChibiOS */
+#   define latency_now()    ((uint16_t)TIME_I2MS(chVTGetSystemTimeX()))
+#else
+#   define latency_now()    timer_read()
+#endif
+
+
+#define QUEUE_MASK  (LATENCY_QUEUE_SIZE - 1)
+
+typedef struct {
+    uint16_t event_time;
+    uint16_t done_time;
+    uint8_t  seq;
+} latency_entry_t;
+
+/*
+ * Single producer/consumer queue of tagged reports:
+ *     head: written by latency_report_queued()
+ *     done: IN transfer completed, advanced in ISR
+ *     tail: consumed into statistics
+ *
+ * Every report written to endpoint takes a sequence number, tagged or not,
+ * and every IN completion retires the next one. An entry is done when its
+ * number is retired, so untagged reports retire no entry.
+ */
+static latency_entry_t queue[LATENCY_QUEUE_SIZE];
+static volatile uint8_t queue_head = 0;
+static volatile uint8_t queue_done = 0;
+static uint8_t queue_tail = 0;
+static volatile uint8_t seq_sent = 0;
+static volatile uint8_t seq_done = 0;
+
+/* tag of event being processed, 0 for none */
+static uint16_t latency_tag = 0;
+
+static uint16_t count = 0;
+static uint16_t lost = 0;
+static uint32_t sum = 0;
+static uint16_t min = UINT16_MAX;
+static uint16_t max = 0;
+static uint16_t hist[LATENCY_HIST_SIZE];
+
+
+static void collect(void)
+{
+    while (queue_tail != queue_done) {
+        latency_entry_t *e = &queue[queue_tail];
+        // event time is rounded up to odd number; don't go negative
+        int16_t ms = (int16_t)(e->done_time - e->event_time);
+        uint16_t t = (ms < 0) ? 0 : ms;
+        queue_tail = (queue_tail + 1) & QUEUE_MASK;
+
+        if (count == UINT16_MAX) continue;
+        count++;
+        sum += t;
+        if (t < min) min = t;
+        if (t > max) max = t;
+        hist[(t < LATENCY_HIST_SIZE - 1) ? t : LATENCY_HIST_SIZE - 1]++;
+    }
+}
+
+/* Tag of key event which is processed now. Called from process_action. */
+void latency_event(keyevent_t event)
+{
+    latency_tag = event.time;
+}
+
+/* Event has been processed, report sent later is not of the event. */
+void latency_event_end(void)
+{
+    latency_tag = 0;
+}
+
+/* Keyboard report has been written to endpoint. */
+void latency_report_queued(void)
+{
+    // entry is in place before its number can be retired by ISR
+    uint8_t seq = seq_sent + 1;
+    if (latency_tag) {
+        collect();
+        uint8_t next = (queue_head + 1) & QUEUE_MASK;
+        if (next == queue_tail) {
+            lost++;
+        } else {
+            queue[queue_head].event_time = latency_tag;
+            queue[queue_head].seq = seq;
+            queue_head = next;
+        }
+        // following reports of the same event are not counted
+        latency_tag = 0;
+    }
+    seq_sent = seq;
+}
+
+bool latency_report_pending(void)
+{
+    return queue_done != queue_head;
+}
+
+/* IN transfer of a keyboard report has completed. Called from ISR. */
+void latency_report_done(void)
+{
+    if (seq_done == seq_sent) return;
+    seq_done++;
+
+    uint8_t i = queue_done;
+    if (i == queue_head || queue[i].seq != seq_done) return;
+    queue[i].done_time = latency_now();
+    queue_done = (i + 1) & QUEUE_MASK;
+}
+
+void latency_clear(void)
+{
+    collect();
+    count = 0;
+    lost = 0;
+    sum = 0;
+    min = UINT16_MAX;
+    max = 0;
+    for (uint8_t i = 0; i < LATENCY_HIST_SIZE; i++) {
+        hist[i] = 0;
+    }
+}
+
+void latency_print(void)
+{
+    collect();
+    if (count == 0) {
+        print("no report\n");
+        return;
+    }
+    xprintf("count: %u\tlost: %u\n", count, lost);
+    xprintf("min: %u\tavg: %u\tmax: %u [ms]\n", min, (uint16_t)(sum / count), max);
+    print("hist:");
+    for (uint8_t i = 0; i < LATENCY_HIST_SIZE; i++) {
+        if (i == LATENCY_HIST_SIZE - 1) {
+            xprintf(" >=%u:%u", i, hist[i]);
+        } else {
+            xprintf(" %u:%u", i, hist[i]);
+        }
+    }
+    print("\n");
+}
@@ -0,0 +1,80 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "keyboard.h"
+
+
+/*
+ * End-to-end key latency tracer
+ *
+ * Time of a key event detected in keyboard_task(keyevent_t.time) is taken
+ * as tag in process_action and attached to the keyboard report sent next
+ * within action_exec; an event which sends no report(ex. layer key) leaves
+ * no tag. Protocol driver calls latency_report_queued for every report
+ * written to endpoint and latency_report_done once for every IN transfer
+ * gone to host:
+ *     LUFA:    SOF event finds keyboard endpoint bank empty, once for each
+ *              report written since last SOF
+ *     ChibiOS: kbd_in_cb/nkro_in_cb
+ * Histogram of latency in 1ms resolution is dumped with 'l' command.
+ */
+
+/* in-flight reports, 2^n */
+#ifndef LATENCY_QUEUE_SIZE
+#define LATENCY_QUEUE_SIZE  8
+#endif
+
+/* number of histogram buckets: 0ms, 1ms, ... and rest */
+#ifndef LATENCY_HIST_SIZE
+#define LATENCY_HIST_SIZE   16
+#endif
+
+
+#ifdef LATENCY_ENABLE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void latency_event(keyevent_t event);
+void latency_event_end(void);
+void latency_report_queued(void);
+bool latency_report_pending(void);
+void latency_report_done(void);     // called from ISR
+void latency_print(void);
+void latency_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#else
+
+#define latency_event(event)
+#define latency_event_end()
+#define latency_report_queued()
+#define latency_report_pending()    false
+#define latency_report_done()
+
+#endif
+
+#endif
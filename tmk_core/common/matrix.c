@@ -16,6 +16,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "print.h"
 #include "matrix.h"
+#include "ghost.h"
 
 
 __attribute__ ((weak))
@@ -78,13 +79,8 @@ __attribute__ ((weak))
 bool matrix_has_ghost_in_row(uint8_t row)
 {
     matrix_row_t matrix_row = matrix_get_row(row);
-    // No ghost exists when less than 2 keys are down on the row
-    if (((matrix_row - 1) & matrix_row) == 0)
-        return false;
-
-    // Ghost occurs when the row shares column line with other row
-    for (uint8_t i=0; i < MATRIX_ROWS; i++) {
-        if (i != row && (matrix_get_row(i) & matrix_row))
+    for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+        if ((matrix_row & ((matrix_row_t)1<<c)) && ghost_is_ambiguous(row, c))
             return true;
     }
     return false;
@@ -93,3 +89,5 @@ bool matrix_has_ghost_in_row(uint8_t row)
 
 __attribute__ ((weak)) void matrix_power_up(void) {}
 __attribute__ ((weak)) void matrix_power_down(void) {}
+__attribute__ ((weak)) bool matrix_wakeup_enable(void) { return false; }
+__attribute__ ((weak)) void matrix_wakeup_disable(void) {}
@@ -71,6 +71,9 @@ bool matrix_has_ghost_in_row(uint8_t row);
 /* power control */
 void matrix_power_up(void);
 void matrix_power_down(void);
+/* wake from suspend on key interrupt, returns false if not supported */
+bool matrix_wakeup_enable(void);
+void matrix_wakeup_disable(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,64 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATRIX_BG_H
+#define MATRIX_BG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+
+
+/*
+ * Background matrix scan(ChibiOS)
+ *
+ * Timer interrupt steps through rows: it reads columns of the row selected
+ * at previous step and selects next row, so that each row settles for an
+ * interval without busy wait in keyboard_task. Complete scans are stored in
+ * two buffers alternately and matrix_scan takes the latest with
+ * matrix_bg_read.
+ *
+ * GPT driver MATRIX_BG_GPTD is used as the timer when it is defined in
+ * config.h(HAL_USE_GPT and the timer should be enabled in halconf/mcuconf),
+ * otherwise a virtual timer steps on system ticks, which needs
+ * CH_CFG_ST_FREQUENCY high enough for MATRIX_BG_INTERVAL.
+ */
+
+/* us per row */
+#ifndef MATRIX_BG_INTERVAL
+#define MATRIX_BG_INTERVAL      50
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void matrix_bg_start(void);
+/* Copies latest scan to rows. Returns false if no scan is done since last call. */
+bool matrix_bg_read(matrix_row_t rows[MATRIX_ROWS]);
+
+/* board matrix.c implements these, called in ISR */
+void matrix_bg_select_row(uint8_t row);
+void matrix_bg_unselect_rows(void);
+matrix_row_t matrix_bg_read_cols(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
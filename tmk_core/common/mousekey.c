@@ -171,7 +171,7 @@ void mousekey_off(uint8_t code)
 void mousekey_send(void)
 {
     mousekey_debug();
-    host_mouse_send(&mouse_report);
+    host_mouse_add(MOUSE_SOURCE_MOUSEKEY, &mouse_report);
     last_timer = timer_read();
 }
 
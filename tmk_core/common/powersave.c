@@ -0,0 +1,95 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+#include "timer.h"
+#include "suspend.h"
+#include "debug.h"
+#include "powersave.h"
+
+
+static uint32_t last_activity = 0;
+static uint16_t last_scan = 0;
+static uint8_t state = POWERSAVE_ACTIVE;
+
+
+static void set_state(uint8_t s)
+{
+    if (state == s) return;
+    state = s;
+    dprintf("powersave: %u\n", s);
+}
+
+/* Returns true when matrix should be scanned. */
+bool powersave_ready(void)
+{
+    uint32_t elapsed = timer_elapsed32(last_activity);
+    uint8_t interval;
+    if (elapsed < POWERSAVE_IDLE_TIMEOUT) {
+        set_state(POWERSAVE_ACTIVE);
+        return true;
+    } else if (POWERSAVE_SLEEP_TIMEOUT == 0 || elapsed < POWERSAVE_SLEEP_TIMEOUT) {
+        set_state(POWERSAVE_IDLE);
+        interval = POWERSAVE_IDLE_INTERVAL;
+    } else {
+        set_state(POWERSAVE_SLEEP);
+        interval = POWERSAVE_SLEEP_INTERVAL;
+    }
+    return timer_elapsed(last_scan) >= interval;
+}
+
+/*
+ * Called at end of keyboard_task which didn't scan, after all other jobs.
+ * MCU idles until next interrupt, timer tick at latest. Powering down is
+ * skipped when mouse is read in keyboard_task as its motion would be lost.
+ */
+void powersave_idle(void)
+{
+    if (state == POWERSAVE_ACTIVE) return;
+#if !defined(PS2_MOUSE_ENABLE) && !defined(SERIAL_MOUSE_ENABLE) && !defined(ADB_MOUSE_ENABLE)
+    if (state == POWERSAVE_SLEEP) {
+        suspend_power_down();
+        return;
+    }
+#endif
+    suspend_idle(1);
+}
+
+/* Key down keeps full rate, which also covers change of matrix. */
+void powersave_scanned(void)
+{
+    last_scan = timer_read();
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        if (matrix_get_row(r)) {
+            powersave_activity();
+            return;
+        }
+    }
+}
+
+void powersave_activity(void)
+{
+    last_activity = timer_read32();
+    set_state(POWERSAVE_ACTIVE);
+}
+
+uint8_t powersave_state(void)
+{
+    return state;
+}
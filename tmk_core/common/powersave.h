@@ -0,0 +1,89 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef POWERSAVE_H
+#define POWERSAVE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*
+ * Activity-based scan rate
+ *
+ * Matrix is scanned at full rate while keys are in use. When no key is down
+ * for POWERSAVE_IDLE_TIMEOUT matrix is scanned every POWERSAVE_IDLE_INTERVAL
+ * and MCU idles between scans. After POWERSAVE_SLEEP_TIMEOUT it is powered
+ * down between scans with suspend_power_down(), which does nothing while
+ * USB is configured. First key down detected returns to full rate.
+ *
+ * Only matrix scan is throttled; other jobs of keyboard_task, e.g. mouse,
+ * LED and EEPROM, run on every call before MCU idles.
+ */
+enum powersave_state {
+    POWERSAVE_ACTIVE = 0,
+    POWERSAVE_IDLE,
+    POWERSAVE_SLEEP,
+};
+
+/* ms without key to reduce scan rate */
+#ifndef POWERSAVE_IDLE_TIMEOUT
+#define POWERSAVE_IDLE_TIMEOUT      5000
+#endif
+
+/* ms between scans in idle */
+#ifndef POWERSAVE_IDLE_INTERVAL
+#define POWERSAVE_IDLE_INTERVAL     10
+#endif
+
+/* ms without key to power down between scans, 0 not to */
+#ifndef POWERSAVE_SLEEP_TIMEOUT
+#define POWERSAVE_SLEEP_TIMEOUT     60000
+#endif
+
+/* ms between scans in sleep */
+#ifndef POWERSAVE_SLEEP_INTERVAL
+#define POWERSAVE_SLEEP_INTERVAL    30
+#endif
+
+
+#ifdef POWERSAVE_ENABLE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* called from keyboard_task */
+bool powersave_ready(void);
+void powersave_scanned(void);
+void powersave_idle(void);
+
+/* user activity other than matrix, e.g. mouse */
+void powersave_activity(void);
+uint8_t powersave_state(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#else
+
+#define powersave_activity()
+
+#endif
+
+#endif
@@ -0,0 +1,194 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdint.h>
+#include "timer.h"
+#include "print.h"
+#include "profile.h"
+
+#if defined(__AVR__)
+#   include <avr/io.h>
+#   include <avr/interrupt.h>
+#elif defined(PROTOCOL_CHIBIOS)
+#   include "ch.h"
+#   include "hal.h"
+#endif
+
+
+typedef struct {
+    uint32_t count;
+    uint32_t sum;
+    profile_tick_t min;
+    profile_tick_t max;
+    uint16_t hist[PROFILE_HIST_SIZE];
+} profile_stat_t;
+
+static profile_stat_t stats[PROFILE_STAGES];
+
+/* upper bounds of histogram buckets in ticks */
+static profile_tick_t hist_bound[PROFILE_HIST_SIZE - 1];
+
+static uint16_t scan_count = 0;
+static uint16_t scan_time = 0;
+static uint16_t scan_rate = 0;
+
+
+/*
+ * Raw tick source
+ */
+#if defined(__AVR__)
+/* Timer0 counts TIMER_RAW_TOP+1 ticks per 1ms in CTC mode, see avr/timer.c */
+#define TICKS_PER_MS    (TIMER_RAW_TOP + 1)
+
+static uint32_t tick_freq(void) { return (uint32_t)TICKS_PER_MS * 1000; }
+
+profile_tick_t profile_ticks(void)
+{
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t ms = timer_count;
+    uint8_t raw = TIMER_RAW;
+    // compare match not serviced yet
+#ifdef TIFR0
+    if ((TIFR0 & (1<<OCF0A)) && raw < TIMER_RAW_TOP) {
+#else
+    if ((TIFR & (1<<OCF0A)) && raw < TIMER_RAW_TOP) {
+#endif
+        ms++;
+    }
+    SREG = sreg;
+    return ms * TICKS_PER_MS + raw;
+}
+
+#elif defined(PROTOCOL_CHIBIOS) && defined(__CORTEX_M) && (__CORTEX_M >= 3)
+/* DWT cycle counter */
+static uint32_t tick_freq(void) { return SystemCoreClock; }
+
+profile_tick_t profile_ticks(void)
+{
+    return DWT->CYCCNT;
+}
+
+#elif defined(PROTOCOL_CHIBIOS)
+/* Cortex-M0/M0+ has no cycle counter: use system time */
+static uint32_t tick_freq(void) { return CH_CFG_ST_FREQUENCY; }
+
+profile_tick_t profile_ticks(void)
+{
+    return chVTGetSystemTimeX();
+}
+
+#else
+static uint32_t tick_freq(void) { return 1000; }
+
+profile_tick_t profile_ticks(void)
+{
+    return timer_read32();
+}
+#endif
+
+static uint32_t ticks_to_us(uint32_t ticks)
+{
+    uint32_t freq = tick_freq();
+    if (freq >= 1000000) {
+        return ticks / (freq / 1000000);
+    } else {
+        return ticks * (1000000 / freq);
+    }
+}
+
+
+void profile_init(void)
+{
+#if defined(PROTOCOL_CHIBIOS) && defined(__CORTEX_M) && (__CORTEX_M >= 3)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    // 16us, 64us, 256us, ... in ticks
+    uint32_t freq = tick_freq();
+    uint32_t us = 16;
+    for (uint8_t i = 0; i < PROFILE_HIST_SIZE - 1; i++, us *= 4) {
+        uint32_t t = (freq >= 1000000) ? us * (freq / 1000000) : us / (1000000 / freq);
+        hist_bound[i] = (t > (profile_tick_t)-1) ? (profile_tick_t)-1 : t;
+    }
+    profile_clear();
+}
+
+void profile_clear(void)
+{
+    for (uint8_t i = 0; i < PROFILE_STAGES; i++) {
+        stats[i] = (profile_stat_t){ .min = (profile_tick_t)-1 };
+    }
+}
+
+void profile_record(uint8_t stage, profile_tick_t ticks)
+{
+    profile_stat_t *s = &stats[stage];
+    if (s->count == UINT32_MAX) return;
+
+    s->count++;
+    s->sum += ticks;
+    if (ticks < s->min) s->min = ticks;
+    if (ticks > s->max) s->max = ticks;
+
+    uint8_t i = 0;
+    while (i < PROFILE_HIST_SIZE - 1 && ticks >= hist_bound[i]) i++;
+    if (s->hist[i] < UINT16_MAX) s->hist[i]++;
+}
+
+/* Count scans to calculate scan rate. Called once per matrix scan, not when
+ * powersave or sof_sync holds scan back. */
+void profile_scan(void)
+{
+    scan_count++;
+    if (timer_elapsed(scan_time) >= 1000) {
+        scan_time = timer_read();
+        scan_rate = scan_count;
+        scan_count = 0;
+    }
+}
+
+static void print_stage(uint8_t stage)
+{
+    profile_stat_t *s = &stats[stage];
+    if (s->count == 0) {
+        print("-\n");
+        return;
+    }
+    xprintf("%lu\t%lu\t%lu\t%lu\t",
+            s->count, ticks_to_us(s->min), ticks_to_us(s->sum / s->count), ticks_to_us(s->max));
+    for (uint8_t i = 0; i < PROFILE_HIST_SIZE; i++) {
+        xprintf(" %u", s->hist[i]);
+    }
+    print("\n");
+}
+
+void profile_print(void)
+{
+    xprintf("scan rate: %u/s\ttick: %lu Hz\n", scan_rate, tick_freq());
+    print("stage\tcount\tmin\tavg\tmax[us]\thist(<16us,x4,...)\n");
+    print("task\t");    print_stage(PROFILE_KEYBOARD_TASK);
+    print("matrix\t");  print_stage(PROFILE_MATRIX_SCAN);
+    print("action\t");  print_stage(PROFILE_ACTION_EXEC);
+    print("tapping\t"); print_stage(PROFILE_TAPPING);
+    print("send\t");    print_stage(PROFILE_HOST_SEND);
+    print("mousekey\t");print_stage(PROFILE_MOUSEKEY);
+    print("ps2mouse\t");print_stage(PROFILE_PS2_MOUSE);
+    print("console\t"); print_stage(PROFILE_CONSOLE);
+}
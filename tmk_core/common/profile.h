@@ -0,0 +1,83 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+
+/*
+ * Per-stage profiler of keyboard_task
+ *
+ * Stages are timed with raw hardware timer: TIMER_RAW(Timer0) on AVR and
+ * DWT cycle counter on Cortex-M3/M4. min/avg/max and histogram of each stage
+ * and scan rate are dumped with 'p' command.
+ * Stages can nest: ACTION includes TAPPING and HOST_SEND.
+ */
+enum profile_stage {
+    PROFILE_KEYBOARD_TASK = 0,
+    PROFILE_MATRIX_SCAN,
+    PROFILE_ACTION_EXEC,
+    PROFILE_TAPPING,
+    PROFILE_HOST_SEND,
+    PROFILE_MOUSEKEY,
+    PROFILE_PS2_MOUSE,
+    PROFILE_CONSOLE,
+    PROFILE_STAGES
+};
+
+/* number of histogram buckets: <16us, <64us, ... x4 each, and rest */
+#define PROFILE_HIST_SIZE   8
+
+#if defined(__AVR__)
+typedef uint16_t profile_tick_t;
+#else
+typedef uint32_t profile_tick_t;
+#endif
+
+
+#ifdef PROFILE_ENABLE
+
+#define PROFILE_BEGIN(stage)    profile_tick_t profile_begin_##stage = profile_ticks()
+#define PROFILE_END(stage)      profile_record(PROFILE_##stage, profile_ticks() - profile_begin_##stage)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void profile_init(void);
+profile_tick_t profile_ticks(void);
+void profile_record(uint8_t stage, profile_tick_t ticks);
+void profile_scan(void);
+void profile_print(void);
+void profile_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#else
+
+#define PROFILE_BEGIN(stage)
+#define PROFILE_END(stage)
+#define profile_init()
+#define profile_scan()
+
+#endif
+
+#endif
@@ -0,0 +1,117 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sof_sync.h"
+
+
+/* largest 2^n not above bInterval */
+#define SEED_PERIOD ( \
+    SOF_SYNC_INTERVAL >= 128 ? 128 : \
+    SOF_SYNC_INTERVAL >= 64 ? 64 : \
+    SOF_SYNC_INTERVAL >= 32 ? 32 : \
+    SOF_SYNC_INTERVAL >= 16 ? 16 : \
+    SOF_SYNC_INTERVAL >= 8 ? 8 : \
+    SOF_SYNC_INTERVAL >= 4 ? 4 : \
+    SOF_SYNC_INTERVAL >= 2 ? 2 : 1)
+
+/* updated in ISR */
+static volatile uint8_t frame = 0;          // SOF count
+static volatile uint8_t poll_frame = 0;     // frame of last IN poll
+static volatile uint8_t poll_count = 0;
+static volatile uint8_t period = SEED_PERIOD;
+
+/* frames a keyboard_task takes plus one */
+static uint8_t lead = 1;
+static uint8_t scan_max = 0;
+static uint8_t scan_count = 0;
+static uint8_t scan_start = 0;
+static bool aligned = false;
+
+
+void sof_sync_reset(void)
+{
+    poll_count = 0;
+    period = SEED_PERIOD;
+}
+
+/* Called on every SOF */
+void sof_sync_frame(void)
+{
+    frame++;
+}
+
+/* Host polled keyboard IN endpoint 'frames_ago' frames before */
+void sof_sync_poll(uint8_t frames_ago)
+{
+    uint8_t f = frame - frames_ago;
+    if (poll_count) {
+        // interval between polls is multiple of period; period is 2^n
+        uint8_t d = f - poll_frame;
+        uint8_t low = d & -d;
+        if (low && low < period) period = low;
+    }
+    poll_frame = f;
+    if (poll_count < UINT8_MAX) poll_count++;
+}
+
+/* Whether matrix should be scanned now */
+bool sof_sync_ready(void)
+{
+    uint8_t p = period;
+    uint8_t now = frame;
+    scan_start = now;
+
+    if (poll_count < SOF_SYNC_LOCK_POLLS || lead * 2 >= p) {
+        return true;
+    }
+
+    // frames until next poll frame, 0 in poll frame
+    uint8_t to_poll = (poll_frame - now) & (p - 1);
+    if (to_poll > lead) {
+        aligned = false;
+    }
+
+    if (to_poll > lead * 2) {
+        // free scan completes before aligned scan starts
+        return true;
+    }
+    if (to_poll == lead) {
+        if (aligned) return false;
+        aligned = true;
+        return true;
+    }
+    if (to_poll < lead) {
+        return true;
+    }
+    return false;
+}
+
+/* Called at end of keyboard_task to learn how long a scan takes */
+void sof_sync_scanned(void)
+{
+    uint8_t n = frame - scan_start;
+    if (n > scan_max) scan_max = n;
+    if (n + 1 > lead) lead = n + 1;
+
+    // shrink lead to max of recent scans
+    if (++scan_count == 0) {
+        lead = scan_max + 1;
+        scan_max = 0;
+    }
+}
@@ -0,0 +1,83 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SOF_SYNC_H
+#define SOF_SYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*
+ * SOF synchronized keyboard_task
+ *
+ * Host polls keyboard IN endpoint at fixed frames. Protocol driver counts
+ * frames with SOF and tells when it sees a poll, from which period and phase
+ * of host polling are learned. Matrix scan in keyboard_task is then held
+ * back so that it starts 'lead' frames before poll frame and its report is
+ * ready just in time, where 'lead' is the number of frames a keyboard_task
+ * takes plus one. Other jobs of keyboard_task are never held back.
+ *
+ * LUFA samples polls on SOF: the host NAKs on empty endpoint are seen as
+ * well as completed reports, so it locks on while no key changes. ChibiOS
+ * learns only from completed reports, so it needs SOF_SYNC_LOCK_POLLS
+ * reports after reset or suspend before it locks on.
+ *
+ * Far from poll frame the scan runs freely as before. Until polling is
+ * learned, or when scan is too long for the period(NKRO at 1ms interval),
+ * it never waits.
+ */
+
+/* bInterval of keyboard IN endpoint. Hosts round it down to 2^n frames. */
+#ifndef SOF_SYNC_INTERVAL
+#define SOF_SYNC_INTERVAL   10
+#endif
+
+/* polls to observe before locking to them */
+#ifndef SOF_SYNC_LOCK_POLLS
+#define SOF_SYNC_LOCK_POLLS 4
+#endif
+
+
+#ifdef SOF_SYNC_ENABLE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* called from protocol driver, possibly in ISR */
+void sof_sync_reset(void);
+void sof_sync_frame(void);
+void sof_sync_poll(uint8_t frames_ago);
+
+/* called from keyboard_task */
+bool sof_sync_ready(void);
+void sof_sync_scanned(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#else
+
+#define sof_sync_reset()
+#define sof_sync_frame()
+#define sof_sync_poll(frames_ago)
+
+#endif
+
+#endif
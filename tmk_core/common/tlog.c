@@ -0,0 +1,104 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sendchar.h"
+#include "tlog.h"
+
+
+#define TLOG_MASK   (TLOG_BUFFER_SIZE - 1)
+
+static uint8_t tlog_buf[TLOG_BUFFER_SIZE];
+static uint8_t tlog_head = 0;
+static uint8_t tlog_tail = 0;
+
+/* number of records lost due to buffer full */
+uint16_t tlog_dropped = 0;
+
+
+static inline uint8_t tlog_free(void)
+{
+    return (tlog_tail - tlog_head - 1) & TLOG_MASK;
+}
+
+static inline void tlog_write(uint8_t data)
+{
+    tlog_buf[tlog_head] = data;
+    tlog_head = (tlog_head + 1) & TLOG_MASK;
+}
+
+/* Reserve a record and write its header. Returns false when record is dropped. */
+bool tlog_begin(const char *fmt, uint8_t size)
+{
+    uint8_t len = sizeof(fmt) + size;
+    if (tlog_free() < len + 1) {
+        tlog_dropped++;
+        return false;
+    }
+    tlog_write(len);
+    tlog_put(&fmt, sizeof(fmt));
+    return true;
+}
+
+void tlog_put(const void *data, uint8_t size)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    while (size--) {
+        tlog_write(*p++);
+    }
+}
+
+static void tlog_send(uint8_t data)
+{
+    if (data == 0x00 || data == '\n' || data == TLOG_MARKER || data == TLOG_ESC) {
+        sendchar(TLOG_ESC);
+        data ^= 0x20;
+    }
+    sendchar(data);
+}
+
+/* Stream records to console. Called from keyboard_task. */
+void tlog_task(void)
+{
+    uint8_t budget = TLOG_TASK_BYTES;
+
+    // report lost records with null format
+    if (tlog_dropped && tlog_free() >= sizeof(char *) + sizeof(tlog_dropped) + 1) {
+        const char *fmt = 0;
+        tlog_write(sizeof(fmt) + sizeof(tlog_dropped));
+        tlog_put(&fmt, sizeof(fmt));
+        tlog_put(&tlog_dropped, sizeof(tlog_dropped));
+        tlog_dropped = 0;
+    }
+
+    // budget counts bytes before stuffing
+    while (tlog_head != tlog_tail) {
+        uint8_t len = tlog_buf[tlog_tail];
+        // whole record at once so that text output won't be mixed into it
+        if (len + 2 > budget && budget != TLOG_TASK_BYTES) break;
+
+        sendchar(TLOG_MARKER);
+        tlog_send(len);
+        tlog_tail = (tlog_tail + 1) & TLOG_MASK;
+        for (uint8_t i = 0; i < len; i++) {
+            tlog_send(tlog_buf[tlog_tail]);
+            tlog_tail = (tlog_tail + 1) & TLOG_MASK;
+        }
+        budget = (len + 2 < budget) ? budget - (len + 2) : 0;
+    }
+}
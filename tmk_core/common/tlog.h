@@ -0,0 +1,101 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TLOG_H
+#define TLOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "progmem.h"
+
+/*
+ * Tokenized log
+ *
+ * A log site is recorded as address of its format string followed by raw
+ * argument values, instead of being formatted on device. Records are kept in
+ * RAM ring and streamed to console in tlog_task(). tool/tlog_decode.py reads
+ * format strings from ELF file and prints the log as text.
+ *
+ * Stream: TLOG_MARKER, length, format address(pointer size, LE), arguments
+ * Arguments are stored with their size after integer promotion, that is,
+ * the same size xprintf would read with va_arg.
+ *
+ * Bytes after the marker are stuffed: 0x00, '\n', TLOG_MARKER and TLOG_ESC
+ * are sent as TLOG_ESC followed by the byte XOR 0x20. Console pads frames
+ * with 0x00 and flushes on '\n', so those never appear within a record and
+ * decoder can skip padding, and resync on marker or newline when console
+ * drops a byte.
+ */
+#define TLOG_MARKER     0x1E
+#define TLOG_ESC        0x1F
+
+#ifndef TLOG_BUFFER_SIZE
+#define TLOG_BUFFER_SIZE    128     // 2^n and up to 256
+#endif
+
+/* max bytes streamed per tlog_task() call; a record is never split. */
+#ifndef TLOG_TASK_BYTES
+#define TLOG_TASK_BYTES     32
+#endif
+
+#ifndef PSTR
+#define PSTR(s) (s)
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern uint16_t tlog_dropped;
+
+bool tlog_begin(const char *fmt, uint8_t size);
+void tlog_put(const void *data, uint8_t size);
+void tlog_task(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+/* Apply macro to each of up to 8 arguments */
+#define TLOG_NARG(...)      TLOG_NARG_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define TLOG_NARG_(_0, _1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+#define TLOG_CAT(a, b)      TLOG_CAT_(a, b)
+#define TLOG_CAT_(a, b)     a ## b
+#define TLOG_EACH(m, ...)   TLOG_CAT(TLOG_EACH_, TLOG_NARG(__VA_ARGS__))(m, ##__VA_ARGS__)
+#define TLOG_EACH_0(m)
+#define TLOG_EACH_1(m, a)       m(a)
+#define TLOG_EACH_2(m, a, ...)  m(a) TLOG_EACH_1(m, __VA_ARGS__)
+#define TLOG_EACH_3(m, a, ...)  m(a) TLOG_EACH_2(m, __VA_ARGS__)
+#define TLOG_EACH_4(m, a, ...)  m(a) TLOG_EACH_3(m, __VA_ARGS__)
+#define TLOG_EACH_5(m, a, ...)  m(a) TLOG_EACH_4(m, __VA_ARGS__)
+#define TLOG_EACH_6(m, a, ...)  m(a) TLOG_EACH_5(m, __VA_ARGS__)
+#define TLOG_EACH_7(m, a, ...)  m(a) TLOG_EACH_6(m, __VA_ARGS__)
+#define TLOG_EACH_8(m, a, ...)  m(a) TLOG_EACH_7(m, __VA_ARGS__)
+
+#define TLOG_SIZE(x)    + sizeof((x) + 0)
+#define TLOG_ARG(x)     { __typeof__((x) + 0) tlog_v = (x); tlog_put(&tlog_v, sizeof(tlog_v)); }
+
+/* format must be string literal in xprintf syntax */
+#define tlog(fmt, ...)  do { \
+    if (tlog_begin(PSTR(fmt), 0 TLOG_EACH(TLOG_SIZE, ##__VA_ARGS__))) { \
+        TLOG_EACH(TLOG_ARG, ##__VA_ARGS__) \
+    } \
+} while (0)
+
+#endif
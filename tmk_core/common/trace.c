@@ -0,0 +1,78 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+#include "print.h"
+#include "trace.h"
+
+
+#if (TRACE_SIZE > 255)
+#   error "TRACE_SIZE should be 255 or less."
+#endif
+
+static trace_record_t ring[TRACE_SIZE];
+static uint8_t head = 0;            // next to write
+static uint8_t count = 0;
+static uint16_t dropped = 0;
+static uint16_t last_time = 0;
+static uint32_t last_time32 = 0;
+
+
+void trace_event(keyevent_t event)
+{
+    if (IS_NOEVENT(event)) return;
+
+    // time of first record counts from clear, long idle is saturated
+    uint16_t delta = event.time - last_time;
+    if (timer_elapsed32(last_time32) > UINT16_MAX) delta = UINT16_MAX;
+    last_time = event.time;
+    last_time32 = timer_read32();
+
+    ring[head] = (trace_record_t){
+        .row = event.key.row,
+        .col = event.key.col | (event.pressed ? TRACE_PRESSED : 0),
+        .delta = delta
+    };
+    head = (head + 1) % TRACE_SIZE;
+    if (count < TRACE_SIZE) {
+        count++;
+    } else {
+        dropped++;
+    }
+}
+
+void trace_print(void)
+{
+    xprintf("trace: %u records, %u dropped\n", count, dropped);
+    uint8_t i = (head + TRACE_SIZE - count) % TRACE_SIZE;
+    for (uint8_t n = 0; n < count; n++) {
+        if (n % 8 == 0) print("T:");
+        xprintf(" %02X%02X%04X", ring[i].row, ring[i].col, ring[i].delta);
+        if (n % 8 == 7 || n == count - 1) print("\n");
+        i = (i + 1) % TRACE_SIZE;
+    }
+}
+
+void trace_clear(void)
+{
+    count = 0;
+    dropped = 0;
+    last_time = timer_read();
+    last_time32 = timer_read32();
+}
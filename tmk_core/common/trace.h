@@ -0,0 +1,72 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "keyboard.h"
+
+
+/*
+ * Key event trace
+ *
+ * Key events are recorded into RAM ring as they are passed to action_exec
+ * and dumped over console with 't' command. The oldest records are
+ * overwritten when the ring is full. The dump is replayed on host with
+ * tool/replay to reproduce report stream of the firmware.
+ *
+ * Record(4 bytes): row, col | 0x80 when pressed, ms from previous record
+ * Dump line:       "T:" followed by records in hex "RRCCDDDD"
+ */
+
+/* number of records */
+#ifndef TRACE_SIZE
+#define TRACE_SIZE      64
+#endif
+
+#define TRACE_PRESSED   0x80
+
+typedef struct {
+    uint8_t row;
+    uint8_t col;
+    uint16_t delta;
+} trace_record_t;
+
+
+#ifdef TRACE_ENABLE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void trace_event(keyevent_t event);
+void trace_print(void);
+void trace_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#else
+
+#define trace_event(event)
+
+#endif
+
+#endif
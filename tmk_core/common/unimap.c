@@ -2,9 +2,8 @@
 #include "action.h"
 #include "unimap.h"
 #include "print.h"
-#if defined(__AVR__)
-#   include <avr/pgmspace.h>
-#endif
+#include "util.h"
+#include "progmem.h"
 
 
 /* Keymapping with 16bit action codes */
@@ -13,6 +12,23 @@ extern const action_t actionmaps[][UNIMAP_ROWS][UNIMAP_COLS];
 // table translates matrix to universal keymap
 extern const uint8_t unimap_trans[MATRIX_ROWS][MATRIX_COLS];
 
+#ifdef UNIMAP_PRECOMPOSE
+#   ifdef KEYMAP_SECTION_ENABLE
+#       error "UNIMAP_PRECOMPOSE can't be used with KEYMAP_SECTION_ENABLE."
+#   endif
+// actionmaps composed with unimap_trans at build time, see tool/unimap_compose.py
+#   ifdef UNIMAP_SPARSE
+// Only non-transparent actions of layer are stored in actionmaps_packed from
+// actionmaps_base[layer]. Bit of actionmaps_index[layer][i][0] is set for key
+// with the action and [1] is number of the actions before the eight keys.
+extern const uint8_t actionmaps_index[][UNIMAP_SPARSE_INDEX][2];
+extern const uint16_t actionmaps_base[];
+extern const action_t actionmaps_packed[];
+#   else
+extern const action_t actionmaps_matrix[][MATRIX_ROWS * MATRIX_COLS];
+#   endif
+#endif
+
 
 
 // translates raw matrix to universal map
@@ -34,6 +50,25 @@ keypos_t unimap_translate(keypos_t key)
 __attribute__ ((weak))
 action_t action_for_key(uint8_t layer, keypos_t key)
 {
+#if defined(UNIMAP_SPARSE)
+    uint16_t i = key.row * MATRIX_COLS + key.col;
+    uint8_t bit = 1 << (i & 0x7);
+    uint8_t bits = pgm_read_byte(&actionmaps_index[(layer)][i / 8][0]);
+    if (!(bits & bit)) {
+        return (action_t)ACTION_TRANSPARENT;
+    }
+    // rank of the action in layer
+    uint16_t n = pgm_read_word(&actionmaps_base[(layer)]) +
+                 pgm_read_byte(&actionmaps_index[(layer)][i / 8][1]) +
+                 bitpop(bits & (bit - 1));
+    return (action_t)pgm_read_word(&actionmaps_packed[n]);
+#elif defined(UNIMAP_PRECOMPOSE)
+#if defined(__AVR__)
+    return (action_t)pgm_read_word(&actionmaps_matrix[(layer)][(key.row) * MATRIX_COLS + (key.col)]);
+#else
+    return actionmaps_matrix[(layer)][(key.row) * MATRIX_COLS + (key.col)];
+#endif
+#else
     keypos_t uni = unimap_translate(key);
     if ((uni.row << 4 | uni.col) == UNIMAP_NO) {
         return (action_t)ACTION_NO;
@@ -43,6 +78,7 @@ action_t action_for_key(uint8_t layer, keypos_t key)
 #else
     return actionmaps[(layer)][(uni.row & 0x7)][(uni.col)];
 #endif
+#endif
 }
 
 /* Macro */
@@ -15,6 +15,9 @@ Copyright 2016 Jun Wako <wakojun@gmail.com>
 #define UNIMAP_ROWS 8
 #define UNIMAP_COLS 16
 
+// Sparse action table(UNIMAP_SPARSE): bitmap and rank for each 8 keys of matrix
+#define UNIMAP_SPARSE_INDEX ((MATRIX_ROWS * MATRIX_COLS + 7) / 8)
+
 /* Universal 128-key keyboard layout(8x16)
         ,-----------------------------------------------.
         |F13|F14|F15|F16|F17|F18|F19|F20|F21|F22|F23|F24|
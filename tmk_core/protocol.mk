@@ -27,13 +27,15 @@ endif
 
 
 ifeq (yes,$(strip $(SERIAL_MOUSE_MICROSOFT_ENABLE)))
-    SRC += $(PROTOCOL_DIR)/serial_mouse_microsoft.c
+    SRC += $(PROTOCOL_DIR)/serial_mouse.c \
+           $(PROTOCOL_DIR)/serial_mouse_microsoft.c
     OPT_DEFS += -DSERIAL_MOUSE_ENABLE -DSERIAL_MOUSE_MICROSOFT \
                 -DMOUSE_ENABLE
 endif
 
 ifeq (yes,$(strip $(SERIAL_MOUSE_MOUSESYSTEMS_ENABLE)))
-    SRC += $(PROTOCOL_DIR)/serial_mouse_mousesystems.c
+    SRC += $(PROTOCOL_DIR)/serial_mouse.c \
+           $(PROTOCOL_DIR)/serial_mouse_mousesystems.c
     OPT_DEFS += -DSERIAL_MOUSE_ENABLE -DSERIAL_MOUSE_MOUSESYSTEMS \
                 -DMOUSE_ENABLE
 endif
@@ -36,6 +36,7 @@
 #endif
 #include "suspend.h"
 #include "hook.h"
+#include "print.h"
 
 
 /* -------------------------
@@ -76,6 +77,114 @@ void hook_usb_suspend_loop(void) {
   }
 }
 
+#ifdef SCAN_THREAD_ENABLE
+/* Scan thread
+ *
+ * Matrix is scanned at fixed interval in a thread of higher priority than
+ * main thread, which handles actions, reports and console. Key changes are
+ * posted to mailbox and main thread is woken up to process them. matrix_scan
+ * must not print in the thread since console and tlog are not thread-safe.
+ *
+ * While USB is suspended main thread scans matrix for wakeup instead. It
+ * takes scan_lock with scan_pause, which waits for scan in progress, and
+ * scan thread doesn't scan until scan_resume gives it back.
+ */
+#ifndef SCAN_THREAD_PRIO
+#define SCAN_THREAD_PRIO      (NORMALPRIO + 8)
+#endif
+/* priority of main thread */
+#ifndef KEYBOARD_THREAD_PRIO
+#define KEYBOARD_THREAD_PRIO  NORMALPRIO
+#endif
+/* us between scans */
+#ifndef SCAN_THREAD_INTERVAL
+#define SCAN_THREAD_INTERVAL  1000
+#endif
+#ifndef SCAN_THREAD_STACK
+#define SCAN_THREAD_STACK     256
+#endif
+#define SCAN_EVENTS           32
+#define SCAN_EVENT_FLAG       EVENT_MASK(0)
+#define SCAN_TICKS            ((TIME_US2I(SCAN_THREAD_INTERVAL) > 0) ? TIME_US2I(SCAN_THREAD_INTERVAL) : 1)
+
+static msg_t scan_buffer[SCAN_EVENTS];
+static MAILBOX_DECL(scan_mailbox, scan_buffer, SCAN_EVENTS);
+static thread_t *keyboard_thread;
+static THD_WORKING_AREA(waScanThread, SCAN_THREAD_STACK);
+/* held by thread which scans matrix, binary semaphore has no priority inheritance */
+static BSEMAPHORE_DECL(scan_lock, false);
+
+/* keyevent_t in msg_t: time(16) | pressed(1) row(7) | col(8) */
+static void scan_post(keyevent_t e) {
+  msg_t msg = (msg_t)(((uint32_t)e.time << 16) | (e.pressed ? 0x8000 : 0) |
+                      ((uint32_t)(e.key.row & 0x7F) << 8) | e.key.col);
+  // waits while mailbox is full, matrix_events doesn't lose key
+  chMBPostTimeout(&scan_mailbox, msg, TIME_INFINITE);
+  chEvtSignal(keyboard_thread, SCAN_EVENT_FLAG);
+}
+
+bool keyboard_scan_fetch(keyevent_t *event) {
+  msg_t msg;
+  if(chMBFetchTimeout(&scan_mailbox, &msg, TIME_IMMEDIATE) != MSG_OK)
+    return false;
+
+  *event = (keyevent_t){
+    .key = (keypos_t){ .row = (msg >> 8) & 0x7F, .col = msg & 0xFF },
+    .pressed = (msg & 0x8000),
+    .time = (uint32_t)msg >> 16
+  };
+  return true;
+}
+
+static THD_FUNCTION(scanThread, arg) {
+  (void)arg;
+  chRegSetThreadName("scan");
+  systime_t time = chVTGetSystemTime();
+  while(true) {
+    // blocks while main thread scans matrix in suspend
+    chBSemWait(&scan_lock);
+    keyboard_scan(scan_post);
+    chBSemSignal(&scan_lock);
+
+    // restart interval after pause instead of catching up
+    systime_t now = chVTGetSystemTime();
+    if(!chTimeIsInRangeX(now, time, chTimeAddX(time, SCAN_TICKS))) {
+      time = now;
+    }
+    time = chThdSleepUntilWindowed(time, chTimeAddX(time, SCAN_TICKS));
+  }
+}
+
+/* stops scan thread, returns after scan in progress is done */
+static void scan_pause(void) {
+  // scan thread can be blocked on full mailbox, process events to let it finish
+  while(chBSemWaitTimeout(&scan_lock, TIME_IMMEDIATE) != MSG_OK) {
+    keyboard_task();
+    chThdSleepMilliseconds(1);
+  }
+}
+
+static void scan_resume(void) {
+  chBSemSignal(&scan_lock);
+}
+
+/* bytes of stack never used, needs CH_DBG_FILL_THREADS */
+static uint32_t stack_unused(const uint8_t *base, const uint8_t *end) {
+  const uint8_t *p = base;
+  while(p < end && *p == CH_DBG_STACK_FILL_VALUE) p++;
+  return p - base;
+}
+
+void keyboard_scan_print(void) {
+  extern uint8_t __process_stack_base__[], __process_stack_end__[];
+  xprintf("stack unused: scan %u/%u main %u/%u\n",
+          (unsigned)stack_unused((const uint8_t *)waScanThread, (const uint8_t *)waScanThread + sizeof(waScanThread)),
+          (unsigned)sizeof(waScanThread),
+          (unsigned)stack_unused(__process_stack_base__, __process_stack_end__),
+          (unsigned)(__process_stack_end__ - __process_stack_base__));
+}
+#endif
+
 /* TESTING
  * Amber LED blinker thread, times are in milliseconds.
  */
@@ -141,14 +250,31 @@ int main(void) {
 
   hook_late_init();
 
+#ifdef SCAN_THREAD_ENABLE
+  keyboard_thread = chThdGetSelfX();
+  chThdSetPriority(KEYBOARD_THREAD_PRIO);
+  chThdCreateStatic(waScanThread, sizeof(waScanThread), SCAN_THREAD_PRIO, scanThread, NULL);
+#endif
+
   /* Main loop */
   while(true) {
+#ifdef SCAN_THREAD_ENABLE
+    /* sleep until key changes, or 1ms for tasks like mousekey */
+    chEvtWaitAnyTimeout(SCAN_EVENT_FLAG, TIME_MS2I(1));
+#endif
 
     if(USB_DRIVER.state == USB_SUSPENDED) {
       print("[s]");
+#ifdef SCAN_THREAD_ENABLE
+      // suspend_wakeup_condition scans matrix in main thread
+      scan_pause();
+#endif
       while(USB_DRIVER.state == USB_SUSPENDED) {
         hook_usb_suspend_loop();
       }
+#ifdef SCAN_THREAD_ENABLE
+      scan_resume();
+#endif
       /* Woken up */
       // variables have been already cleared
       send_keyboard_report();
@@ -28,6 +28,8 @@
 #include "led.h"
 #endif
 #include "hook.h"
+#include "latency.h"
+#include "sof_sync.h"
 
 /* TMK hooks */
 __attribute__((weak))
@@ -787,6 +789,7 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
   switch(event) {
   case USB_EVENT_RESET:
     //TODO: from ISR! print("[R]");
+    sof_sync_reset();
     return;
 
   case USB_EVENT_ADDRESS:
@@ -814,6 +817,7 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
 
   case USB_EVENT_SUSPEND:
     //TODO: from ISR! print("[S]");
+    sof_sync_reset();
     hook_usb_suspend_entry();
     return;
 
@@ -1006,6 +1010,9 @@ static bool usb_request_hook_cb(USBDriver *usbp) {
 /* Start-of-frame callback */
 static void usb_sof_cb(USBDriver *usbp) {
   kbd_sof_cb(usbp);
+#ifdef CONSOLE_ENABLE
+  console_sof_cb(usbp);
+#endif
 }
 
 
@@ -1066,17 +1073,19 @@ void send_remote_wakeup(USBDriver *usbp) {
 
 /* keyboard IN callback hander (a kbd report has made it IN) */
 void kbd_in_cb(USBDriver *usbp, usbep_t ep) {
-  /* STUB */
   (void)usbp;
   (void)ep;
+  latency_report_done();
+  sof_sync_poll(0);
 }
 
 #ifdef NKRO_ENABLE
 /* nkro IN callback hander (a nkro report has made it IN) */
 void nkro_in_cb(USBDriver *usbp, usbep_t ep) {
-  /* STUB */
   (void)usbp;
   (void)ep;
+  latency_report_done();
+  sof_sync_poll(0);
 }
 #endif /* NKRO_ENABLE */
 
@@ -1085,6 +1094,7 @@ void nkro_in_cb(USBDriver *usbp, usbep_t ep) {
  *  so that this is not going to have to be checked every 1ms */
 void kbd_sof_cb(USBDriver *usbp) {
   (void)usbp;
+  sof_sync_frame();
 }
 
 /* Idle requests timer code
@@ -1150,6 +1160,7 @@ void send_keyboard(report_keyboard_t *report) {
       osalThreadSuspendS(&(&USB_DRIVER)->epc[NKRO_ENDPOINT]->in_state->thread);
     }
     usbStartTransmitI(&USB_DRIVER, NKRO_ENDPOINT, (uint8_t *)report, sizeof(report_keyboard_t));
+    latency_report_queued();
     osalSysUnlock();
   } else
 #endif /* NKRO_ENABLE */
@@ -1165,6 +1176,7 @@ void send_keyboard(report_keyboard_t *report) {
       osalThreadSuspendS(&(&USB_DRIVER)->epc[KBD_ENDPOINT]->in_state->thread);
     }
     usbStartTransmitI(&USB_DRIVER, KBD_ENDPOINT, (uint8_t *)report, KBD_EPSIZE);
+    latency_report_queued();
     osalSysUnlock();
   }
   keyboard_report_sent = *report;
@@ -1313,28 +1325,17 @@ void console_queue_onotify(io_buffers_queue_t *bqp) {
   }
 }
 
-/* Flush timer code
- * callback (called from ISR, unlocked state) */
-static void console_flush_cb(void *arg) {
-  USBDriver *usbp = (USBDriver *)arg;
-  osalSysLockFromISR();
-
+/* Transmit partially filled buffer if endpoint is idle
+ * (called from ISR, locked state) */
+static void console_flushI(USBDriver *usbp) {
   /* check that the states of things are as they're supposed to */
-  if(usbGetDriverStateI(usbp) != USB_ACTIVE) {
-    /* rearm the timer */
-    chVTSetI(&console_flush_timer, TIME_MS2I(CONSOLE_FLUSH_MS), console_flush_cb, (void *)usbp);
-    osalSysUnlockFromISR();
+  if(usbGetDriverStateI(usbp) != USB_ACTIVE)
     return;
-  }
 
   /* If there is already a transaction ongoing then another one cannot be
      started.*/
-  if (usbGetTransmitStatusI(usbp, CONSOLE_ENDPOINT)) {
-    /* rearm the timer */
-    chVTSetI(&console_flush_timer, TIME_MS2I(CONSOLE_FLUSH_MS), console_flush_cb, (void *)usbp);
-    osalSysUnlockFromISR();
+  if (usbGetTransmitStatusI(usbp, CONSOLE_ENDPOINT))
     return;
-  }
 
   /* Checking if there only a buffer partially filled, if so then it is
      enforced in the queue and transmitted.*/
@@ -1349,6 +1350,24 @@ static void console_flush_cb(void *arg) {
       buf[i]=0;
     usbStartTransmitI(usbp, CONSOLE_ENDPOINT, buf, CONSOLE_EPSIZE);
   }
+}
+
+/* Start-of-frame flush
+ * (called from ISR, unlocked state) */
+void console_sof_cb(USBDriver *usbp) {
+  osalSysLockFromISR();
+  console_flushI(usbp);
+  osalSysUnlockFromISR();
+}
+
+/* Flush timer code
+ * fallback of SOF flush, e.g. SOF is not available on suspend
+ * callback (called from ISR, unlocked state) */
+static void console_flush_cb(void *arg) {
+  USBDriver *usbp = (USBDriver *)arg;
+  osalSysLockFromISR();
+
+  console_flushI(usbp);
 
   /* rearm the timer */
   chVTSetI(&console_flush_timer, TIME_MS2I(CONSOLE_FLUSH_MS), console_flush_cb, (void *)usbp);
@@ -1356,6 +1375,9 @@ static void console_flush_cb(void *arg) {
 }
 
 
+/* number of chars dropped due to queue full */
+uint16_t console_dropped = 0;
+
 int8_t sendchar(uint8_t c) {
   osalSysLock();
   if(usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
@@ -1363,13 +1385,23 @@ int8_t sendchar(uint8_t c) {
     return 0;
   }
   osalSysUnlock();
-  /* Timeout after 100us if the queue is full.
-   * Increase this timeout if too much stuff is getting
-   * dropped (i.e. the buffer is getting full too fast
-   * for USB/HIDRAW to dequeue). Another possibility
-   * for fixing this kind of thing is to increase
-   * CONSOLE_QUEUE_CAPACITY. */
-  return(obqPutTimeout(&console_buf_queue, c, US2ST(100)));
+  /* Chars are accumulated in the queue buffer and a packet is posted when
+   * it gets full, on newline or on SOF. Never block when the queue is full
+   * (i.e. the host doesn't dequeue fast enough); drop the char and count it.
+   * Increase CONSOLE_QUEUE_CAPACITY if too much stuff is getting dropped. */
+  if (obqPutTimeout(&console_buf_queue, c, TIME_IMMEDIATE) != MSG_OK) {
+    console_dropped++;
+    return -1;
+  }
+  if (c == '\n') {
+    console_flush_output();
+  }
+  return 0;
+}
+
+/* Post partially filled buffer to be transmitted */
+void console_flush_output(void) {
+  obqFlush(&console_buf_queue);
 }
 
 #else /* CONSOLE_ENABLE */
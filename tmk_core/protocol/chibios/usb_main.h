@@ -132,6 +132,12 @@ void console_flush_output(void);
 
 /* console IN request callback handler */
 void console_in_cb(USBDriver *usbp, usbep_t ep);
+
+/* start-of-frame handler: flush partially filled packet */
+void console_sof_cb(USBDriver *usbp);
+
+/* number of chars dropped due to queue full */
+extern uint16_t console_dropped;
 #endif /* CONSOLE_ENABLE */
 
 void sendchar_pf(void *p, char c);
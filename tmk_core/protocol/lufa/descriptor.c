@@ -39,6 +39,9 @@
 #include "util.h"
 #include "report.h"
 #include "descriptor.h"
+#ifdef EEKEYMAP_ENABLE
+#include "eekeymap.h"
+#endif
 
 
 /*******************************************************************************
@@ -182,6 +185,14 @@ const USB_Descriptor_HIDReport_Datatype_t PROGMEM ConsoleReport[] =
         HID_RI_REPORT_COUNT(8, CONSOLE_EPSIZE),
         HID_RI_REPORT_SIZE(8, 0x08),
         HID_RI_OUTPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE | HID_IOF_NON_VOLATILE),
+#ifdef EEKEYMAP_ENABLE
+        HID_RI_USAGE(8, 0x77), /* Vendor Usage 0x77: keymap in EEPROM */
+        HID_RI_LOGICAL_MINIMUM(8, 0x00),
+        HID_RI_LOGICAL_MAXIMUM(16, 0x00FF),
+        HID_RI_REPORT_COUNT(8, EEKEYMAP_REPORT_SIZE),
+        HID_RI_REPORT_SIZE(8, 0x08),
+        HID_RI_FEATURE(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE | HID_IOF_NON_VOLATILE),
+#endif
     HID_RI_END_COLLECTION(0),
 };
 #endif
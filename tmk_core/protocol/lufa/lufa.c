@@ -51,6 +51,14 @@
 #include "suspend.h"
 #include "hook.h"
 #include "timer.h"
+#include "profile.h"
+#include "latency.h"
+#include "sof_sync.h"
+#ifdef EEKEYMAP_ENABLE
+#include "eekeymap.h"
+/* report type in high byte of wValue of Get/SetReport */
+#define IS_FEATURE_REPORT(wValue)   (((wValue) >> 8) == 3)
+#endif
 
 #ifdef LUFA_DEBUG_SUART
 #include "avr/suart.h"
@@ -75,6 +83,11 @@ static uint8_t keyboard_led_stats = 0;
 
 static report_keyboard_t keyboard_report_sent;
 
+#if defined(LATENCY_ENABLE) || defined(SOF_SYNC_ENABLE)
+/* number of keyboard reports written since SOF found endpoint bank empty */
+static volatile uint8_t keyboard_in_pending = 0;
+#endif
+
 
 /* Host driver */
 static uint8_t keyboard_leds(void);
@@ -118,49 +131,36 @@ static bool console_is_ready(void)
     return true;
 }
 
+/* number of chars dropped due to buffer full */
+uint16_t console_dropped = 0;
+
+static void console_flush(bool partial);
+
+/* Chars are accumulated in the buffer and written to endpoint in whole
+ * packets: when a packet is full, on newline or once per frame(SOF) from
+ * console_task. This never blocks and drops chars when buffer is full. */
 static bool console_putc(uint8_t c)
 {
-    if (!console_is_ready())
-        goto EXIT;
+    if (!ringbuf_put(&sendbuf, c)) {
+        console_dropped++;
+        return false;
+    }
 
     // return immediately if called while interrupt
     if (!(SREG & (1<<SREG_I)))
-        goto EXIT;
-
-    if (USB_DeviceState != DEVICE_STATE_Configured)
-        goto EXIT;
-
-    uint8_t ep = Endpoint_GetCurrentEndpoint();
-
-    Endpoint_SelectEndpoint(CONSOLE_IN_EPNUM);
-    if (!Endpoint_IsEnabled() || !Endpoint_IsConfigured()) {
-        goto EXIT_RESTORE_EP;
-    }
-
-    // write from buffer to endpoint bank
-    while (!ringbuf_is_empty(&sendbuf) && Endpoint_IsReadWriteAllowed()) {
-        Endpoint_Write_8(ringbuf_get(&sendbuf));
-
-        // clear bank when it is full
-        if (!Endpoint_IsReadWriteAllowed() && Endpoint_IsINReady()) {
-            Endpoint_ClearIN();
-        }
-    }
-
-    // write c to bank directly if there is no others in buffer
-    if (ringbuf_is_empty(&sendbuf) && Endpoint_IsReadWriteAllowed()) {
-        Endpoint_Write_8(c);
-        Endpoint_SelectEndpoint(ep);
         return true;
-    }
 
-EXIT_RESTORE_EP:
-    Endpoint_SelectEndpoint(ep);
-EXIT:
-    return ringbuf_put(&sendbuf, c);
+    if (c == '\n') {
+        console_flush(true);
+    } else if (((sendbuf.head - sendbuf.tail) & sendbuf.size_mask) >= CONSOLE_EPSIZE) {
+        console_flush(false);
+    }
+    return true;
 }
 
-static void console_flush(void)
+/* Write buffer to endpoint bank and send full packets.
+ * Partially filled packet is sent as well when partial is true. */
+static void console_flush(bool partial)
 {
     if (!console_is_ready())
         return;
@@ -187,7 +187,7 @@ static void console_flush(void)
     }
 
     // clear bank when there are chars in bank
-    if (Endpoint_BytesInEndpoint() && Endpoint_IsINReady()) {
+    if (partial && Endpoint_BytesInEndpoint() && Endpoint_IsINReady()) {
         // Windows needs to fill packet with 0
         while (Endpoint_IsReadWriteAllowed()) {
                 Endpoint_Write_8(0);
@@ -205,7 +205,7 @@ static void console_task(void)
         return;
     }
     fn = USB_Device_GetFrameNumber();
-    console_flush();
+    console_flush(true);
 }
 #endif
 
@@ -254,6 +254,7 @@ void EVENT_USB_Device_Reset(void)
 #ifdef LUFA_DEBUG
     print("[R]");
 #endif
+    sof_sync_reset();
 }
 
 void EVENT_USB_Device_Suspend()
@@ -261,6 +262,7 @@ void EVENT_USB_Device_Suspend()
 #ifdef LUFA_DEBUG
     print("[S]");
 #endif
+    sof_sync_reset();
     hook_usb_suspend_entry();
 }
 
@@ -275,6 +277,34 @@ void EVENT_USB_Device_WakeUp()
 // called every 1ms
 void EVENT_USB_Device_StartOfFrame(void)
 {
+    sof_sync_frame();
+
+#if defined(LATENCY_ENABLE) || defined(SOF_SYNC_ENABLE)
+    uint8_t ep = Endpoint_GetCurrentEndpoint();
+#ifdef NKRO_ENABLE
+    Endpoint_SelectEndpoint((keyboard_protocol && keyboard_nkro) ? NKRO_IN_EPNUM : KEYBOARD_IN_EPNUM);
+#else
+    Endpoint_SelectEndpoint(KEYBOARD_IN_EPNUM);
+#endif
+    /* keyboard reports have gone to host in previous frame when bank is empty,
+     * more than one can have been written after the bank became empty once */
+    if (keyboard_in_pending) {
+        if (Endpoint_IsINReady()) {
+            do {
+                latency_report_done();
+            } while (--keyboard_in_pending);
+            sof_sync_poll(1);
+        }
+    }
+#ifdef SOF_SYNC_ENABLE
+    /* host polled empty endpoint in previous frame; clear NAKINI only */
+    else if (UEINTX & (1 << NAKINI)) {
+        UEINTX = (uint8_t)~(1 << NAKINI);
+        sof_sync_poll(1);
+    }
+#endif
+    Endpoint_SelectEndpoint(ep);
+#endif
 }
 
 /** Event handler for the USB_ConfigurationChanged event.
@@ -359,6 +389,14 @@ void EVENT_USB_Device_ControlRequest(void)
                     ReportData = (uint8_t*)&keyboard_report_sent;
                     ReportSize = sizeof(keyboard_report_sent);
                     break;
+#if defined(CONSOLE_ENABLE) && defined(EEKEYMAP_ENABLE)
+                case CONSOLE_INTERFACE:
+                    if (IS_FEATURE_REPORT(USB_ControlRequest.wValue)) {
+                        ReportData = eekeymap_response;
+                        ReportSize = sizeof(eekeymap_response);
+                    }
+                    break;
+#endif
                 }
 
                 /* Write the report data to the control endpoint */
@@ -394,6 +432,19 @@ void EVENT_USB_Device_ControlRequest(void)
                     xprintf("[L%d]", USB_ControlRequest.wIndex);
 #endif
                     break;
+#if defined(CONSOLE_ENABLE) && defined(EEKEYMAP_ENABLE)
+                case CONSOLE_INTERFACE:
+                    if (IS_FEATURE_REPORT(USB_ControlRequest.wValue)) {
+                        /* Feature report: request to keymap in EEPROM */
+                        uint8_t req[EEKEYMAP_REPORT_SIZE] = {};
+                        uint8_t len = (USB_ControlRequest.wLength < sizeof(req)) ? USB_ControlRequest.wLength : sizeof(req);
+                        Endpoint_ClearSETUP();
+                        Endpoint_Read_Control_Stream_LE(req, len);
+                        Endpoint_ClearStatusStage();
+                        eekeymap_request(req, len);
+                    }
+                    break;
+#endif
                 }
 
             }
@@ -506,6 +557,14 @@ static void send_keyboard(report_keyboard_t *report)
 
     /* Finalize the stream transfer to send the last packet */
     Endpoint_ClearIN();
+    latency_report_queued();
+#if defined(LATENCY_ENABLE) || defined(SOF_SYNC_ENABLE)
+    /* SOF event decrements the count in ISR */
+    uint8_t sreg = SREG;
+    cli();
+    keyboard_in_pending++;
+    SREG = sreg;
+#endif
 
     keyboard_report_sent = *report;
 }
@@ -533,6 +592,22 @@ static void send_mouse(report_mouse_t *report)
 #endif
 }
 
+#ifdef MOUSE_ENABLE
+/* Mouse report is kept in host_mouse_add until endpoint bank is free */
+bool host_mouse_ready(void)
+{
+    // send_mouse discards report
+    if (USB_DeviceState != DEVICE_STATE_Configured)
+        return true;
+
+    uint8_t ep = Endpoint_GetCurrentEndpoint();
+    Endpoint_SelectEndpoint(MOUSE_IN_EPNUM);
+    bool ready = Endpoint_IsReadWriteAllowed();
+    Endpoint_SelectEndpoint(ep);
+    return ready;
+}
+#endif
+
 static void send_system(uint16_t data)
 {
 #ifdef EXTRAKEY_ENABLE
@@ -680,7 +755,9 @@ int main(void)
         keyboard_task();
 
 #ifdef CONSOLE_ENABLE
+        PROFILE_BEGIN(CONSOLE);
         console_task();
+        PROFILE_END(CONSOLE);
 #endif
 
 #if !defined(INTERRUPT_CONTROL_ENDPOINT)
@@ -55,6 +55,9 @@ extern "C" {
 #endif
 
 extern host_driver_t lufa_driver;
+#ifdef CONSOLE_ENABLE
+extern uint16_t console_dropped;
+#endif
 
 #ifdef __cplusplus
 }
@@ -42,6 +42,9 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <util/delay.h>
 #include "m0110.h"
 #include "debug.h"
+#ifdef M0110_INT_VECT
+#include "timer.h"
+#endif
 
 
 static inline uint8_t raw2scan(uint8_t raw);
@@ -89,9 +92,141 @@ static inline void request(void);
 uint8_t m0110_error = 0;
 
 
+/*
+ * Queue of raw bytes from keyboard
+ *
+ * With M0110_INT_VECT transfer runs in ISR on edges of clock line and a
+ * command is kept outstanding: Inquiry usually, or Instant after prefix byte
+ * (Keypad/Shift) to get the rest of sequence with next transaction. Raw bytes
+ * are queued and decoded in m0110_recv_key without waiting for keyboard.
+ * Without it raw bytes are read with Instant on demand.
+ */
+#define RAWQ_SIZE   16
+static volatile uint8_t rawq[RAWQ_SIZE];
+static volatile uint8_t rawq_head = 0;
+static volatile uint8_t rawq_tail = 0;
+
+static inline uint8_t rawq_count(void)
+{
+    return (RAWQ_SIZE + rawq_head - rawq_tail) % RAWQ_SIZE;
+}
+
+static inline void rawq_put(uint8_t raw)
+{
+    uint8_t next = (rawq_head + 1) % RAWQ_SIZE;
+    if (next != rawq_tail) {
+        rawq[rawq_head] = raw;
+        rawq_head = next;
+    }
+}
+
+static inline uint8_t rawq_peek(uint8_t i)
+{
+    return rawq[(rawq_tail + i) % RAWQ_SIZE];
+}
+
+static inline void rawq_drop(uint8_t n)
+{
+    rawq_tail = (rawq_tail + n) % RAWQ_SIZE;
+}
+
+#ifdef M0110_INT_VECT
+enum { XFER_IDLE, XFER_SEND, XFER_RECV };
+static volatile uint8_t xfer_state = XFER_IDLE;
+static volatile uint8_t xfer_next = M0110_INQUIRY;
+static uint8_t xfer_command;
+static uint8_t xfer_data;
+static uint8_t xfer_bits;
+static uint16_t xfer_time;
+
+/* Start next transaction, or restart when keyboard doesn't respond */
+static void xfer_task(void)
+{
+    if (xfer_state != XFER_IDLE) {
+        // Inquiry blocks up to 250ms
+        if (timer_elapsed(xfer_time) < 500) return;
+        M0110_INT_OFF();
+        dprintf("m0110 xfer timeout: %u\n", xfer_state);
+        idle();
+        xfer_state = XFER_IDLE;
+        xfer_next = M0110_INQUIRY;
+        M0110_INT_ON();
+    }
+
+    xfer_command = xfer_next;
+    xfer_data = xfer_command;
+    xfer_bits = 0;
+    xfer_time = timer_read();
+    xfer_state = XFER_SEND;
+    request();
+}
+
+ISR(M0110_INT_VECT)
+{
+    bool clock = M0110_CLOCK_PIN & (1<<M0110_CLOCK_BIT);
+    switch (xfer_state) {
+        case XFER_SEND:
+            if (!clock) {
+                // HOST asserts bit on falling edge
+                if (xfer_data & 0x80) {
+                    data_hi();
+                } else {
+                    data_lo();
+                }
+                xfer_data <<= 1;
+            } else if (++xfer_bits == 8) {
+                _delay_us(100); // hold last bit for 80us
+                idle();
+                xfer_bits = 0;
+                xfer_state = XFER_RECV;
+            }
+            break;
+        case XFER_RECV:
+            if (clock) {
+                // HOST reads bit on rising edge
+                xfer_data <<= 1;
+                if (M0110_DATA_PIN & (1<<M0110_DATA_BIT)) {
+                    xfer_data |= 1;
+                }
+                if (++xfer_bits == 8) {
+                    // NULL is queued only as the rest of sequence
+                    if (xfer_data != M0110_NULL || xfer_command == M0110_INSTANT) {
+                        rawq_put(xfer_data);
+                    }
+                    xfer_next = (KEY(xfer_data) == M0110_KEYPAD || KEY(xfer_data) == M0110_SHIFT) ?
+                                M0110_INSTANT : M0110_INQUIRY;
+                    xfer_state = XFER_IDLE;
+                }
+            }
+            break;
+    }
+}
+#endif
+
+/* Returns true when n raw bytes are available */
+static bool rawq_fill(uint8_t n)
+{
+#ifdef M0110_INT_VECT
+    return rawq_count() >= n;
+#else
+    while (rawq_count() < n) {
+        rawq_put(instant());
+    }
+    return true;
+#endif
+}
+
+
+/* m0110_send and m0110_recv can't be used with M0110_INT_VECT */
 void m0110_init(void)
 {
     idle();
+#ifdef M0110_INT_VECT
+    // transfer starts with m0110_recv_key, keyboard may not be ready yet
+    M0110_INT_INIT();
+    M0110_INT_ON();
+    return;
+#endif
     _delay_ms(1000);
 
 /* Not needed to initialize in fact.
@@ -203,7 +338,6 @@ uint8_t m0110_recv_key(void)
 {
     static uint8_t keybuf = 0x00;
     static uint8_t keybuf2 = 0x00;
-    static uint8_t rawbuf = 0x00;
     uint8_t raw, raw2, raw3;
 
     if (keybuf) {
@@ -217,15 +351,18 @@ uint8_t m0110_recv_key(void)
         return raw;
     }
 
-    if (rawbuf) {
-        raw = rawbuf;
-        rawbuf = 0x00;
-    } else {
-        raw = instant();  // Use INSTANT for better response. Should be INQUIRY ?
-    }
+#ifdef M0110_INT_VECT
+    xfer_task();
+#endif
+    // Polling uses INSTANT for better response. Should be INQUIRY ?
+    // Sequence is left in queue until all of its bytes arrive.
+    if (!rawq_fill(1)) return M0110_NULL;
+    raw = rawq_peek(0);
     switch (KEY(raw)) {
         case M0110_KEYPAD:
-            raw2 = instant();
+            if (!rawq_fill(2)) return M0110_NULL;
+            raw2 = rawq_peek(1);
+            rawq_drop(2);
             switch (KEY(raw2)) {
                 case M0110_ARROW_UP:
                 case M0110_ARROW_DOWN:
@@ -242,16 +379,19 @@ uint8_t m0110_recv_key(void)
             return (raw2scan(raw2) | M0110_KEYPAD_OFFSET);
             break;
         case M0110_SHIFT:
-            raw2 = instant();
+            if (!rawq_fill(2)) return M0110_NULL;
+            raw2 = rawq_peek(1);
             switch (KEY(raw2)) {
                 case M0110_SHIFT:
                     // Case: 5-8,C,G,H
-                    rawbuf = raw2;
+                    rawq_drop(1);   // raw2 is decoded next time
                     return raw2scan(raw); // Shift(d/u)
                     break;
                 case M0110_KEYPAD:
                     // Shift + Arrow, Calc, or etc.
-                    raw3 = instant();
+                    if (!rawq_fill(3)) return M0110_NULL;
+                    raw3 = rawq_peek(2);
+                    rawq_drop(3);
                     switch (KEY(raw3)) {
                         case M0110_ARROW_UP:
                         case M0110_ARROW_DOWN:
@@ -291,6 +431,7 @@ uint8_t m0110_recv_key(void)
                     break;
                 default:
                     // Shift + Normal keys
+                    rawq_drop(2);
                     keybuf = raw2scan(raw2);
                     return raw2scan(raw);   // Shift(d/u)
                     break;
@@ -298,6 +439,7 @@ uint8_t m0110_recv_key(void)
             break;
         default:
             // Normal keys
+            rawq_drop(1);
             return raw2scan(raw);
             break;
     }
@@ -148,7 +148,8 @@ void ps2_mouse_task(void)
                     TIMER_DIFF_16(timer_read(), scroll_button_time) < PS2_MOUSE_SCROLL_BTN_SEND) {
                 // send Scroll Button(down and up at once) when not scrolled
                 mouse_report.buttons |= (PS2_MOUSE_SCROLL_BTN_MASK);
-                host_mouse_send(&mouse_report);
+                host_mouse_add(MOUSE_SOURCE_PS2, &mouse_report);
+                host_mouse_task();
                 _delay_ms(100);
                 mouse_report.buttons &= ~(PS2_MOUSE_SCROLL_BTN_MASK);
             }
@@ -160,7 +161,7 @@ void ps2_mouse_task(void)
 #endif
 
 
-        host_mouse_send(&mouse_report);
+        host_mouse_add(MOUSE_SOURCE_PS2, &mouse_report);
         print_usb_data();
     }
     // clear report
@@ -43,5 +43,7 @@ void serial_init(void);
 uint8_t serial_recv(void);
 int16_t serial_recv2(void);
 void serial_send(uint8_t data);
+/* bytes which can be sent without blocking(serial_uart.c) */
+uint8_t serial_send_space(void);
 
 #endif
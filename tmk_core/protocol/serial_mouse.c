@@ -0,0 +1,50 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "serial_mouse.h"
+#include "report.h"
+#include "host.h"
+#include "print.h"
+#include "debug.h"
+
+
+/* Packet is merged into mouse report by host layer, see host_mouse_add. */
+static int8_t clip(int16_t d)
+{
+    /* USB HID uses only values from -127 to 127 */
+    return (d > 127) ? 127 : (d < -127) ? -127 : d;
+}
+
+void serial_mouse_add(uint8_t buttons, int16_t x, int16_t y, int16_t v, int16_t h)
+{
+    report_mouse_t report = {
+        .buttons = buttons,
+        .x = clip(x),
+        .y = clip(y),
+        .v = clip(v),
+        .h = clip(h),
+    };
+
+    if (debug_mouse)
+        xprintf("serial_mouse usb: [%02X|%d %d %d %d]\n",
+                report.buttons, report.x, report.y, report.v, report.h);
+
+    host_mouse_add(MOUSE_SOURCE_SERIAL, &report);
+}
@@ -30,4 +30,7 @@ static inline uint8_t serial_mouse_init(void)
 
 void serial_mouse_task(void);
 
+/* add motion of packet to mouse report(serial_mouse.c) */
+void serial_mouse_add(uint8_t buttons, int16_t x, int16_t y, int16_t v, int16_t h);
+
 #endif
@@ -27,27 +27,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "print.h"
 #include "debug.h"
 
-#ifdef MAX
-#undef MAX
-#endif
-#define MAX(X, Y) ((X) > (Y) ? (X) : (Y))
-
-static void print_usb_data(const report_mouse_t *report);
-
-void serial_mouse_task(void)
+static void parse_byte(uint8_t rcv)
 {
     /* 3 byte ring buffer */
     static uint8_t buffer[3];
     static int buffer_cur = 0;
 
-    static report_mouse_t report = {};
-
-    int16_t rcv;
-
-    rcv = serial_recv2();
-    if (rcv < 0)
-        /* no new data */
-        return;
+    static uint8_t buttons = 0;
 
     if (debug_mouse)
         xprintf("serial_mouse: byte: %04X\n", rcv);
@@ -59,18 +45,15 @@ void serial_mouse_task(void)
     if (rcv & (1 << 6))
         buffer_cur = 0;
 
-    buffer[buffer_cur] = (uint8_t)rcv;
+    buffer[buffer_cur] = rcv;
 
     if (buffer_cur == 0 && buffer[buffer_cur] == 0x20) {
         /*
          * Logitech extension: This must be a follow-up on
          * the last 3-byte packet signaling a middle button click
          */
-        report.buttons |= MOUSE_BTN3;
-        report.x = report.y = 0;
-
-        print_usb_data(&report);
-        host_mouse_send(&report);
+        buttons |= MOUSE_BTN3;
+        serial_mouse_add(buttons, 0, 0, 0, 0);
         return;
     }
 
@@ -86,39 +69,33 @@ void serial_mouse_task(void)
      * if the mouse moved or the button states
      * change.
      */
-    report.buttons = 0;
+    buttons = 0;
     if (buffer[0] & (1 << 5))
-        report.buttons |= MOUSE_BTN1;
+        buttons |= MOUSE_BTN1;
     if (buffer[0] & (1 << 4))
-        report.buttons |= MOUSE_BTN2;
-
-    report.x = (buffer[0] << 6) | buffer[1];
-    report.y = ((buffer[0] << 4) & 0xC0) | buffer[2];
-
-    /* USB HID uses values from -127 to 127 only */
-    report.x = MAX(report.x, -127);
-    report.y = MAX(report.y, -127);
+        buttons |= MOUSE_BTN2;
 
 #if 0
-    if (!report.buttons && !report.x && !report.y) {
+    if (!buttons && !x && !y) {
         /*
          * Microsoft extension: Middle mouse button pressed
          * FIXME: I don't know how exactly this extension works.
          */
-        report.buttons |= MOUSE_BTN3;
+        buttons |= MOUSE_BTN3;
     }
 #endif
 
-    print_usb_data(&report);
-    host_mouse_send(&report);
+    serial_mouse_add(buttons,
+                     (int8_t)((buffer[0] << 6) | buffer[1]),
+                     (int8_t)(((buffer[0] << 4) & 0xC0) | buffer[2]),
+                     0, 0);
 }
 
-static void print_usb_data(const report_mouse_t *report)
+void serial_mouse_task(void)
 {
-    if (!debug_mouse)
-        return;
+    int16_t rcv;
 
-    xprintf("serial_mouse usb: [%02X|%d %d %d %d]\n",
-            report->buttons, report->x, report->y,
-            report->v, report->h);
+    /* all bytes received since last call */
+    while ((rcv = serial_recv2()) >= 0)
+        parse_byte((uint8_t)rcv);
 }
@@ -27,29 +27,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "print.h"
 #include "debug.h"
 
-#ifdef MAX
-#undef MAX
-#endif
-#define MAX(X, Y) ((X) > (Y) ? (X) : (Y))
-
 //#define SERIAL_MOUSE_CENTER_SCROLL
 
-static void print_usb_data(const report_mouse_t *report);
-
-void serial_mouse_task(void)
+static void parse_byte(uint8_t rcv)
 {
     /* 5 byte ring buffer */
     static uint8_t buffer[5];
     static int buffer_cur = 0;
 
-    int16_t rcv;
-
-    report_mouse_t report = {0, 0, 0, 0, 0};
-
-    rcv = serial_recv2();
-    if (rcv < 0)
-        /* no new data */
-        return;
+    uint8_t buttons = 0;
 
     if (debug_mouse)
         xprintf("serial_mouse: byte: %04X\n", rcv);
@@ -64,7 +50,7 @@ void serial_mouse_task(void)
     if (buffer_cur == 0 && (rcv >> 3) != 0x10)
         return;
 
-    buffer[buffer_cur++] = (uint8_t)rcv;
+    buffer[buffer_cur++] = rcv;
 
     if (buffer_cur < 5)
         return;
@@ -72,21 +58,8 @@ void serial_mouse_task(void)
 
 #ifdef SERIAL_MOUSE_CENTER_SCROLL
     if ((buffer[0] & 0x7) == 0x5 && (buffer[1] || buffer[2])) {
-        /* USB HID uses only values from -127 to 127 */
-        report.h = MAX((int8_t)buffer[1], -127);
-        report.v = MAX((int8_t)buffer[2], -127);
-
-        print_usb_data(&report);
-        host_mouse_send(&report);
-
-        if (buffer[3] || buffer[4]) {
-            report.h = MAX((int8_t)buffer[3], -127);
-            report.v = MAX((int8_t)buffer[4], -127);
-
-            print_usb_data(&report);
-            host_mouse_send(&report);
-        }
-
+        serial_mouse_add(buttons, 0, 0, (int8_t)buffer[2], (int8_t)buffer[1]);
+        serial_mouse_add(buttons, 0, 0, (int8_t)buffer[4], (int8_t)buffer[3]);
         return;
     }
 #endif
@@ -98,34 +71,22 @@ void serial_mouse_task(void)
      * change.
      */
     if (!(buffer[0] & (1 << 2)))
-        report.buttons |= MOUSE_BTN1;
+        buttons |= MOUSE_BTN1;
     if (!(buffer[0] & (1 << 1)))
-        report.buttons |= MOUSE_BTN3;
+        buttons |= MOUSE_BTN3;
     if (!(buffer[0] & (1 << 0)))
-        report.buttons |= MOUSE_BTN2;
-
-    /* USB HID uses only values from -127 to 127 */
-    report.x = MAX((int8_t)buffer[1], -127);
-    report.y = MAX(-(int8_t)buffer[2], -127);
-
-    print_usb_data(&report);
-    host_mouse_send(&report);
-
-    if (buffer[3] || buffer[4]) {
-        report.x = MAX((int8_t)buffer[3], -127);
-        report.y = MAX(-(int8_t)buffer[4], -127);
+        buttons |= MOUSE_BTN2;
 
-        print_usb_data(&report);
-        host_mouse_send(&report);
-    }
+    /* two motions in a packet */
+    serial_mouse_add(buttons, (int8_t)buffer[1], -(int8_t)buffer[2], 0, 0);
+    serial_mouse_add(buttons, (int8_t)buffer[3], -(int8_t)buffer[4], 0, 0);
 }
 
-static void print_usb_data(const report_mouse_t *report)
+void serial_mouse_task(void)
 {
-    if (!debug_mouse)
-        return;
+    int16_t rcv;
 
-    xprintf("serial_mouse usb: [%02X|%d %d %d %d]\n",
-            report->buttons, report->x, report->y,
-            report->v, report->h);
+    /* all bytes received since last call */
+    while ((rcv = serial_recv2()) >= 0)
+        parse_byte((uint8_t)rcv);
 }
@@ -94,12 +94,55 @@ int16_t serial_recv2(void)
     return data;
 }
 
+#if defined(SERIAL_UART_TXD_VECT)
+// TX ring buffer drained by data register empty interrupt, which needs
+// SERIAL_UART_TXD_INT_ON() and SERIAL_UART_TXD_INT_OFF() to control it.
+#define TBUF_SIZE   128
+static uint8_t tbuf[TBUF_SIZE];
+static volatile uint8_t tbuf_head = 0;
+static volatile uint8_t tbuf_tail = 0;
+
+void serial_send(uint8_t data)
+{
+    uint8_t next = (tbuf_head + 1) % TBUF_SIZE;
+    while (next == tbuf_tail) {
+        // drop rather than deadlock when called with interrupt disabled
+        if (!(SREG & (1<<SREG_I))) return;
+    }
+    tbuf[tbuf_head] = data;
+    tbuf_head = next;
+    SERIAL_UART_TXD_INT_ON();
+}
+
+uint8_t serial_send_space(void)
+{
+    uint8_t tail = tbuf_tail;
+    return (tail > tbuf_head ? (tail - tbuf_head) : (TBUF_SIZE - tbuf_head + tail)) - 1;
+}
+
+// USART data register empty interrupt
+ISR(SERIAL_UART_TXD_VECT)
+{
+    if (tbuf_head == tbuf_tail) {
+        SERIAL_UART_TXD_INT_OFF();
+        return;
+    }
+    SERIAL_UART_DATA = tbuf[tbuf_tail];
+    tbuf_tail = (tbuf_tail + 1) % TBUF_SIZE;
+}
+#else
 void serial_send(uint8_t data)
 {
     while (!SERIAL_UART_TXD_READY) ;
     SERIAL_UART_DATA = data;
 }
 
+uint8_t serial_send_space(void)
+{
+    return SERIAL_UART_TXD_READY ? 1 : 0;
+}
+#endif
+
 // USART RX complete interrupt
 ISR(SERIAL_UART_RXD_VECT)
 {
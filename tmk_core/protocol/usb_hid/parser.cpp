@@ -2,26 +2,396 @@
 #include "usb_hid.h"
 
 #include "print.h"
+#include "debug.h"
 
 
-void KBDReportParser::Parse(USBHID *hid, bool is_rpt_id, uint8_t len, uint8_t *buf)
+/*
+ * Report layout
+ */
+void KBDReportFormat::Clear()
 {
-    xprintf("input %d:", hid->GetAddress());
+    report_count = 0;
+    field_count = 0;
+    led_iface = 0;
+    led_report_id = 0;
+}
+
+// Boot protocol keyboard: modifiers, reserved, keys[6]
+void KBDReportFormat::SetBoot()
+{
+    Clear();
+    report[0] = (kbd_report_t){ .iface = 0, .report_id = 0, .bits = 64 };
+    report_count = 1;
+    field[0] = (kbd_field_t){ .report = 0, .bit_offset = 0, .size = 1, .count = 8,
+                              .usage_min = 0xE0, .usage_max = 0xE7, .logical_min = 0, .is_array = false };
+    field[1] = (kbd_field_t){ .report = 0, .bit_offset = 16, .size = 8, .count = 6,
+                              .usage_min = 0x00, .usage_max = 0xFF, .logical_min = 0, .is_array = true };
+    field_count = 2;
+}
+
+// find or add report entry
+int8_t KBDReportFormat::GetReport(uint8_t iface, uint8_t report_id)
+{
+    for (uint8_t i = 0; i < report_count; i++) {
+        if (report[i].iface == iface && report[i].report_id == report_id) return i;
+    }
+    if (report_count >= KBD_REPORTS) return -1;
+    report[report_count] = (kbd_report_t){ .iface = iface, .report_id = report_id, .bits = 0 };
+    return report_count++;
+}
+
+// find report entry which an incoming report conforms to
+int8_t KBDReportFormat::FindReport(uint8_t iface, uint8_t len, const uint8_t *buf)
+{
+    int8_t found = -1;
+    for (uint8_t i = 0; i < report_count; i++) {
+        uint8_t id = report[i].report_id;
+        uint8_t size = (report[i].bits + 7) / 8 + (id ? 1 : 0);
+        if (report[i].iface != iface) continue;
+        if (id && buf[0] != id) continue;
+        if (len == size) return i;
+
+        // some devices pad reports up to endpoint size
+        if (found < 0 && len > size) {
+            for (uint8_t j = 0; j < field_count; j++) {
+                if (field[j].report == i) { found = i; break; }
+            }
+        }
+    }
+    return found;
+}
+
+bool KBDReportFormat::AddField(const kbd_field_t &f)
+{
+    if (field_count >= KBD_REPORT_FIELDS) return false;
+    if (f.is_array && ArrayIndex(field_count) + f.count > KBD_ARRAY_KEYS) return false;
+    field[field_count++] = f;
+    return true;
+}
+
+// index of first usage of array field in KBDReportParser::array_keys
+uint8_t KBDReportFormat::ArrayIndex(uint8_t n)
+{
+    uint8_t index = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        if (field[i].is_array) index += field[i].count;
+    }
+    return index;
+}
+
+
+/*
+ * Report descriptor parser
+ */
+void KBDReportDescParser::Reset()
+{
+    remain = 0;
+    long_item = 0;
+    usage_page = 0;
+    report_size = 0;
+    report_count = 0;
+    report_id = 0;
+    logical_min = 0;
+    ClearLocal();
+}
+
+void KBDReportDescParser::Parse(const uint16_t len, const uint8_t *pbuf, const uint16_t &offset)
+{
+    for (uint16_t i = 0; i < len; i++) {
+        uint8_t b = pbuf[i];
+
+        if (long_item == 1) {
+            // bLongItemTag and data follow
+            remain = b + 1;
+            long_item = 2;
+        } else if (long_item == 2) {
+            if (--remain == 0) long_item = 0;
+        } else if (remain == 0) {
+            prefix = b;
+            if (prefix == 0xFE) {
+                long_item = 1;
+                continue;
+            }
+            data_len = ((b & 0x03) == 0x03) ? 4 : (b & 0x03);
+            remain = data_len;
+            data = 0;
+            if (remain == 0) Item();
+        } else {
+            data |= (uint32_t)b << (8 * (data_len - remain));
+            if (--remain == 0) Item();
+        }
+    }
+}
+
+void KBDReportDescParser::Item()
+{
+    uint8_t type = (prefix >> 2) & 0x03;
+    uint8_t tag = prefix >> 4;
+
+    switch (type) {
+    case 0: // Main
+        MainItem(tag);
+        ClearLocal();
+        break;
+    case 1: // Global
+        switch (tag) {
+        case 0x0: usage_page = data; break;
+        case 0x1:
+            // sign extension
+            if (data_len == 1)      logical_min = (int8_t)data;
+            else if (data_len == 2) logical_min = (int16_t)data;
+            else                    logical_min = (int32_t)data;
+            break;
+        case 0x7: report_size = data; break;
+        case 0x8: report_id = data; break;
+        case 0x9: report_count = data; break;
+        }
+        break;
+    case 2: // Local
+        // 4-byte usage contains usage page in upper 16 bits
+        switch (tag) {
+        case 0x0:
+            if (!has_usage) usage_min = data;
+            usage_max = data;
+            has_usage = true;
+            break;
+        case 0x1: usage_min = data; has_usage = true; break;
+        case 0x2: usage_max = data; has_usage = true; break;
+        }
+        break;
+    }
+}
+
+void KBDReportDescParser::MainItem(uint8_t tag)
+{
+    uint16_t page = (usage_min >> 16) ? (usage_min >> 16) : usage_page;
+
+    switch (tag) {
+    case 0x8: { // Input
+        int8_t r = format->GetReport(iface, report_id);
+        if (r < 0) {
+            dprintf("desc: too many reports\n");
+            return;
+        }
+        // Keyboard page and not Constant
+        if (page == 0x07 && !(data & 0x01) && report_size && report_size <= 8) {
+            uint16_t umin = usage_min & 0xFFFF;
+            uint16_t umax = usage_max & 0xFFFF;
+            bool is_array = !(data & 0x02);
+            if (!is_array && umax < umin + report_count - 1) {
+                umax = umin + report_count - 1;
+            }
+            if (umin <= 0xFF) {
+                kbd_field_t f = {
+                    .report = (uint8_t)r,
+                    .bit_offset = format->report[r].bits,
+                    .size = report_size,
+                    .count = report_count,
+                    .usage_min = (uint8_t)umin,
+                    .usage_max = (uint8_t)(umax > 0xFF ? 0xFF : umax),
+                    .logical_min = (uint8_t)logical_min,
+                    .is_array = is_array
+                };
+                if (!format->AddField(f)) {
+                    dprintf("desc: too many fields\n");
+                }
+            }
+        }
+        format->report[r].bits += report_size * report_count;
+        break;
+    }
+    case 0x9: // Output
+        if (page == 0x08) { // LED page
+            format->led_iface = iface;
+            format->led_report_id = report_id;
+        }
+        break;
+    }
+}
+
+
+/*
+ * Keyboard report parser
+ */
+bool KBDReportParser::changed = false;
+
+static uint8_t get_bits(const uint8_t *buf, uint8_t len, uint16_t offset, uint8_t size)
+{
+    uint8_t i = offset / 8;
+    uint16_t v = (i < len ? buf[i] : 0);
+    if (i + 1 < len) v |= buf[i + 1] << 8;
+    return (v >> (offset % 8)) & ((1 << size) - 1);
+}
+
+void KBDReportParser::ParseInput(USBHID *hid, uint8_t iface, uint8_t len, uint8_t *buf)
+{
+    xprintf("input %d/%d:", hid->GetAddress(), iface);
     for (uint8_t i = 0; i < len; i++) {
         xprintf(" %02X", buf[i]);
     }
     xprintf("\r\n");
 
+    if (len == 0) return;
+    int8_t r = format.FindReport(iface, len, buf);
+    if (r < 0) return;
+    if (format.report[r].report_id) {
+        buf++;
+        len--;
+    }
+
     // Rollover error
     // Cherry: 0101010101010101
     // https://geekhack.org/index.php?topic=69169.msg2638223#msg2638223
     // Apple:  0000010101010101
     // https://geekhack.org/index.php?topic=69169.msg2760969#msg2760969
-    if (buf[2] == 0x01) {
-       xprintf("Rollover error: ignored\r\n");
-       return;
+    for (uint8_t i = 0; i < format.field_count; i++) {
+        const kbd_field_t *f = &format.field[i];
+        if (f->report != r || !f->is_array) continue;
+        for (uint8_t j = 0; j < f->count; j++) {
+            uint8_t v = get_bits(buf, len, f->bit_offset + j * f->size, f->size);
+            if (v >= f->logical_min && f->usage_min + (v - f->logical_min) == 0x01) {
+                xprintf("Rollover error: ignored\r\n");
+                return;
+            }
+        }
+    }
+
+    // Each field replaces only its own state: a bitmap field its usage range
+    // and an array field its usage list. Array field of Boot layout covers
+    // 0x00-0xFF and must not clear keys held in bitmap or other reports.
+    for (uint8_t i = 0; i < format.field_count; i++) {
+        const kbd_field_t *f = &format.field[i];
+        if (f->report != r) continue;
+        uint8_t a = format.ArrayIndex(i);
+        for (uint8_t j = 0; j < f->count; j++) {
+            uint8_t v = get_bits(buf, len, f->bit_offset + j * f->size, f->size);
+            uint16_t u;
+            if (f->is_array) {
+                u = f->usage_min + (uint8_t)(v - f->logical_min);
+                // 0x00-0x03 are not keys: no event, rollover, POST fail, undefined
+                if (v < f->logical_min || u > f->usage_max || u < 0x04 || u > 0xFF) u = 0;
+                array_keys[a + j] = u;
+            } else {
+                u = f->usage_min + j;
+                if (u > 0xFF) break;
+                if (v && u >= 0x04) {
+                    keys[u / 8] |= (1 << (u % 8));
+                } else {
+                    keys[u / 8] &= ~(1 << (u % 8));
+                }
+            }
+        }
     }
 
-    ::memcpy(&report, buf, sizeof(report_keyboard_t));
     time_stamp = millis();
+    changed = true;
+}
+
+
+// ORs keys of all reports into dest
+void KBDReportParser::Merge(uint8_t *dest)
+{
+    for (uint8_t i = 0; i < sizeof(keys); i++) {
+        dest[i] |= keys[i];
+    }
+    for (uint8_t i = 0; i < KBD_ARRAY_KEYS; i++) {
+        uint8_t u = array_keys[i];
+        if (u) dest[u / 8] |= (1 << (u % 8));
+    }
+}
+
+
+/*
+ * HID keyboard
+ */
+uint8_t KBDHID::Init(uint8_t parent, uint8_t port, bool lowspeed)
+{
+    input_count = 0;
+    uint8_t rcode = HIDUniversal::Init(parent, port, lowspeed);
+    if (rcode) return rcode;
+
+    if (parser.format.field_count == 0) {
+        xprintf("desc: no keyboard, released\r\n");
+        Release();
+        return USB_DEV_CONFIG_ERROR_DEVICE_NOT_SUPPORTED;
+    }
+    return 0;
+}
+
+// called by HIDUniversal while parsing configuration descriptor in Init()
+void KBDHID::EndpointXtract(uint8_t conf, uint8_t iface, uint8_t alt, uint8_t proto,
+                            const USB_ENDPOINT_DESCRIPTOR *ep)
+{
+    HIDUniversal::EndpointXtract(conf, iface, alt, proto, ep);
+
+    if (alt != 0) return;
+    if ((ep->bmAttributes & bmUSB_TRANSFER_TYPE) != USB_TRANSFER_TYPE_INTERRUPT) return;
+    if (!(ep->bEndpointAddress & 0x80)) return;
+    for (uint8_t i = 0; i < input_count; i++) {
+        if (input[i].iface == iface) return;
+    }
+    if (input_count >= KBD_INTERFACES) return;
+    input[input_count++] = (kbd_input_t){
+        .iface = iface,
+        .ep = (uint8_t)(ep->bEndpointAddress & 0x0F),
+        .size = (uint8_t)(ep->wMaxPacketSize > 0xFF ? 0xFF : ep->wMaxPacketSize),
+        .proto = proto
+    };
+}
+
+uint8_t KBDHID::OnInitSuccessful()
+{
+    parser.format.Clear();
+    for (uint8_t i = 0; i < input_count; i++) {
+        KBDReportDescParser desc(&parser.format, input[i].iface);
+        uint8_t rcode = GetReportDescr(input[i].iface, &desc);
+        if (rcode) {
+            xprintf("desc: error %02X\r\n", rcode);
+        }
+    }
+
+    // Boot layout only for interface which claims it
+    if (parser.format.field_count == 0) {
+        for (uint8_t i = 0; i < input_count; i++) {
+            if (input[i].proto != 1) continue;
+            xprintf("desc: no keyboard field, Boot keyboard interface %d\r\n", input[i].iface);
+            parser.format.SetBoot();
+            parser.format.report[0].iface = input[i].iface;
+            break;
+        }
+    }
+    xprintf("desc: %d reports %d fields\r\n", parser.format.report_count, parser.format.field_count);
+    parser.Clear();
+    return 0;
+}
+
+uint8_t KBDHID::Poll()
+{
+    if (!isReady()) return 0;
+    if ((int16_t)((uint16_t)millis() - next_poll) < 0) return 0;
+    next_poll = (uint16_t)millis() + KBD_POLL_INTERVAL;
+
+    uint8_t buf[KBD_INPUT_SIZE];
+    for (uint8_t i = 0; i < input_count; i++) {
+        uint16_t read = input[i].size;
+        if (read > sizeof(buf)) read = sizeof(buf);
+
+        uint8_t rcode = pUsb->inTransfer(GetAddress(), input[i].ep, &read, buf);
+        if (rcode) {
+            if (rcode != hrNAK) xprintf("poll %d: error %02X\r\n", input[i].iface, rcode);
+            continue;
+        }
+        parser.ParseInput(this, input[i].iface, read, buf);
+    }
+    return 0;
+}
+
+uint8_t KBDHID::SetLED(uint8_t led)
+{
+    uint8_t buf[2];
+    uint8_t id = parser.format.led_report_id;
+    // data stage starts with Report ID when the device uses it
+    buf[0] = id;
+    buf[1] = led;
+    return SetReport(0, parser.format.led_iface, 2, id, (id ? 2 : 1), (id ? buf : &buf[1]));
 }
@@ -2,14 +2,181 @@
 #define PARSER_H
 
 #include "usbhid.h"
+#include "hiduniversal.h"
+#include "parsetools.h"
 #include "report.h"
 
+
+/* Max number of keyboard page fields kept from report descriptors per device */
+#ifndef KBD_REPORT_FIELDS
+#define KBD_REPORT_FIELDS   8
+#endif
+/* Max number of Input reports(interface and Report ID pair) per device */
+#ifndef KBD_REPORTS
+#define KBD_REPORTS         6
+#endif
+/* Max number of keys held in array fields of all reports per device */
+#ifndef KBD_ARRAY_KEYS
+#define KBD_ARRAY_KEYS      16
+#endif
+/* Max number of HID interfaces with Interrupt IN endpoint per device */
+#ifndef KBD_INTERFACES
+#define KBD_INTERFACES      3
+#endif
+
+/* Input report declared in report descriptor */
+typedef struct {
+    uint8_t  iface;
+    uint8_t  report_id;     // 0: no Report ID
+    uint16_t bits;          // total size of Input items
+} kbd_report_t;
+
+/* Keyboard/Keypad page(0x07) Input field */
+typedef struct {
+    uint8_t  report;        // index of kbd_report_t
+    uint16_t bit_offset;    // offset from first byte after Report ID
+    uint8_t  size;          // Report Size in bits
+    uint8_t  count;         // Report Count
+    uint8_t  usage_min;
+    uint8_t  usage_max;
+    uint8_t  logical_min;
+    bool     is_array;      // Array(usage list) or Variable(bitmap)
+} kbd_field_t;
+
+/* Report layout of a keyboard device
+ * Boot protocol layout is used until report descriptor is parsed.
+ */
+class KBDReportFormat
+{
+public:
+    kbd_report_t report[KBD_REPORTS];
+    uint8_t report_count;
+    kbd_field_t field[KBD_REPORT_FIELDS];
+    uint8_t field_count;
+    uint8_t led_iface;
+    uint8_t led_report_id;
+
+    void Clear();
+    void SetBoot();
+    int8_t GetReport(uint8_t iface, uint8_t report_id);
+    int8_t FindReport(uint8_t iface, uint8_t len, const uint8_t *buf);
+    bool AddField(const kbd_field_t &f);
+    uint8_t ArrayIndex(uint8_t field);
+};
+
+/* Streaming HID report descriptor parser
+ * Only items needed to locate keyboard Input fields and LED Output are handled.
+ */
+class KBDReportDescParser : public USBReadParser
+{
+public:
+    KBDReportDescParser(KBDReportFormat *fmt, uint8_t ifc) : format(fmt), iface(ifc) { Reset(); }
+    virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint16_t &offset);
+
+private:
+    KBDReportFormat *format;
+    uint8_t  iface;
+
+    // item being read
+    uint8_t  prefix;
+    uint8_t  remain;
+    uint8_t  data_len;
+    uint32_t data;
+    uint8_t  long_item;     // 1: reading bDataSize, 2: skipping data
+
+    // global items
+    uint16_t usage_page;
+    uint8_t  report_size;
+    uint8_t  report_count;
+    uint8_t  report_id;
+    int32_t  logical_min;
+    // local items
+    uint32_t usage_min;
+    uint32_t usage_max;
+    bool     has_usage;
+
+    void Reset();
+    void Item();
+    void MainItem(uint8_t tag);
+    void ClearLocal() { usage_min = usage_max = 0; has_usage = false; }
+};
+
+/* Keyboard report parser
+ * Keeps state of each field by itself so that a report doesn't affect keys
+ * held in other reports: bitmap fields in 256-bit bitmap indexed by usage ID,
+ * which each field updates in its own usage range, and array fields in list
+ * of usages. Merge() ORs both into bitmap of caller.
+ */
 class KBDReportParser : public HIDReportParser
 {
 public:
-    report_keyboard_t report;
+    uint8_t keys[32];
+    uint8_t array_keys[KBD_ARRAY_KEYS];
     uint16_t time_stamp;
-    virtual void Parse(USBHID *hid, bool is_rpt_id, uint8_t len, uint8_t *buf);
+    KBDReportFormat format;
+
+    // set when any parser updates its keys, cleared by reader
+    static bool changed;
+
+    KBDReportParser() { format.SetBoot(); Clear(); }
+    void Clear() {
+        ::memset(keys, 0, sizeof(keys));
+        ::memset(array_keys, 0, sizeof(array_keys));
+        changed = true;
+    }
+    void Merge(uint8_t *dest);
+    void ParseInput(USBHID *hid, uint8_t iface, uint8_t len, uint8_t *buf);
+    // HIDReportParser interface doesn't tell interface; assumes the first one
+    virtual void Parse(USBHID *hid, bool is_rpt_id, uint8_t len, uint8_t *buf) {
+        ParseInput(hid, format.report[0].iface, len, buf);
+    }
+};
+
+/* Interval of polling Input endpoints in ms */
+#ifndef KBD_POLL_INTERVAL
+#define KBD_POLL_INTERVAL   1
+#endif
+/* Max length of Input report read from endpoint */
+#ifndef KBD_INPUT_SIZE
+#define KBD_INPUT_SIZE      64
+#endif
+
+/* Interrupt IN endpoint of HID interface */
+typedef struct {
+    uint8_t iface;
+    uint8_t ep;             // endpoint number
+    uint8_t size;           // max packet size
+    uint8_t proto;          // bInterfaceProtocol, 1: Boot keyboard
+} kbd_input_t;
+
+/* HID keyboard in Report protocol
+ * Report descriptor of each interface is parsed so that NKRO bitmap reports
+ * can be consumed as well as Boot protocol compatible 6KRO reports.
+ * Poll() reads endpoint of each interface by itself so that the parser can
+ * match reports with interface as well as Report ID. The endpoints are taken
+ * from configuration descriptor in EndpointXtract() since interface table of
+ * HIDUniversal is not public. A device without keyboard field nor Boot
+ * keyboard interface is released in Init() and leaves its slot to others.
+ */
+class KBDHID : public HIDUniversal
+{
+public:
+    KBDReportParser parser;
+
+    KBDHID(USB *p) : HIDUniversal(p), input_count(0), next_poll(0) {}
+    uint8_t SetLED(uint8_t led);
+    virtual uint8_t Init(uint8_t parent, uint8_t port, bool lowspeed);
+    virtual uint8_t Poll();
+    virtual void EndpointXtract(uint8_t conf, uint8_t iface, uint8_t alt, uint8_t proto,
+                                const USB_ENDPOINT_DESCRIPTOR *ep);
+
+protected:
+    virtual uint8_t OnInitSuccessful();
+
+private:
+    kbd_input_t input[KBD_INTERFACES];
+    uint8_t input_count;
+    uint16_t next_poll;
 };
 
 #endif
@@ -325,6 +325,7 @@ MSG_EXTENDED_LISTING = Creating Extended Listing:
 MSG_SYMBOL_TABLE = Creating Symbol Table:
 MSG_LINKING = Linking:
 MSG_COMPILING = Compiling C:
+MSG_COMPOSING = Composing unimap:
 MSG_COMPILING_CPP = Compiling C++:
 MSG_ASSEMBLING = Assembling:
 MSG_CLEANING = Cleaning project:
@@ -333,6 +334,15 @@ MSG_CREATING_LIBRARY = Creating library:
 
 
 
+# Action table composed from unimap_trans and actionmaps(UNIMAP_PRECOMPOSE)
+ifneq (,$(filter -DUNIMAP_PRECOMPOSE,$(OPT_DEFS)))
+UNIMAP_MATRIX = $(OBJDIR)/unimap_matrix.c
+SRC += $(UNIMAP_MATRIX)
+ifneq (,$(filter -DUNIMAP_SPARSE,$(OPT_DEFS)))
+UNIMAP_COMPOSE_FLAGS = --sparse
+endif
+endif
+
 # Define all object files.
 OBJ = $(patsubst %.c,$(OBJDIR)/%.o,$(patsubst %.cpp,$(OBJDIR)/%.o,$(patsubst %.S,$(OBJDIR)/%.o,$(SRC))))
 
@@ -557,6 +567,15 @@ $(OBJDIR)/%.o : %.c
 	$(CC) -c $(ALL_CFLAGS) $< -o $@ 
 
 
+# Compose: create matrix-indexed action table from objects of keymap.
+ifdef UNIMAP_MATRIX
+$(UNIMAP_MATRIX): $(filter-out $(OBJDIR)/$(UNIMAP_MATRIX:.c=.o),$(OBJ))
+	@echo
+	@echo $(MSG_COMPOSING) $@
+	python3 $(TMK_DIR)/tool/unimap_compose.py $(UNIMAP_COMPOSE_FLAGS) $@ $^
+endif
+
+
 # Compile: create object files from C++ source files.
 $(OBJDIR)/%.o : %.cpp
 	@echo
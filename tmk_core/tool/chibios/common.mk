@@ -11,6 +11,7 @@ SRC +=	$(COMMON_DIR)/host.c \
 	$(COMMON_DIR)/debug.c \
 	$(COMMON_DIR)/util.c \
 	$(COMMON_DIR)/hook.c \
+	$(COMMON_DIR)/ghost.c \
 	$(COMMON_DIR)/chibios/suspend.c \
 	$(COMMON_DIR)/chibios/printf.c \
 	$(COMMON_DIR)/chibios/timer.c \
@@ -20,7 +21,8 @@ SRC +=	$(COMMON_DIR)/host.c \
 # Option modules
 ifdef BOOTMAGIC_ENABLE
     SRC += $(COMMON_DIR)/bootmagic.c
-    SRC += $(COMMON_DIR)/chibios/eeconfig.c
+    SRC += $(COMMON_DIR)/eeconfig.c
+    SRC += $(COMMON_DIR)/chibios/eeprom.c
     OPT_DEFS += -DBOOTMAGIC_ENABLE
 endif
 
@@ -65,6 +67,45 @@ ifdef BACKLIGHT_ENABLE
     OPT_DEFS += -DBACKLIGHT_ENABLE
 endif
 
+ifdef TLOG_ENABLE
+    SRC += $(COMMON_DIR)/tlog.c
+    OPT_DEFS += -DTLOG_ENABLE
+endif
+
+ifdef PROFILE_ENABLE
+    SRC += $(COMMON_DIR)/profile.c
+    OPT_DEFS += -DPROFILE_ENABLE
+endif
+
+ifdef LATENCY_ENABLE
+    SRC += $(COMMON_DIR)/latency.c
+    OPT_DEFS += -DLATENCY_ENABLE
+endif
+
+ifdef TRACE_ENABLE
+    SRC += $(COMMON_DIR)/trace.c
+    OPT_DEFS += -DTRACE_ENABLE
+endif
+
+ifdef SOF_SYNC_ENABLE
+    SRC += $(COMMON_DIR)/sof_sync.c
+    OPT_DEFS += -DSOF_SYNC_ENABLE
+endif
+
+ifdef POWERSAVE_ENABLE
+    SRC += $(COMMON_DIR)/powersave.c
+    OPT_DEFS += -DPOWERSAVE_ENABLE
+endif
+
+ifdef MATRIX_BG_ENABLE
+    SRC += $(COMMON_DIR)/chibios/matrix_bg.c
+    OPT_DEFS += -DMATRIX_BG_ENABLE
+endif
+
+ifdef SCAN_THREAD_ENABLE
+    OPT_DEFS += -DSCAN_THREAD_ENABLE
+endif
+
 ifdef KEYMAP_SECTION_ENABLE
     OPT_DEFS += -DKEYMAP_SECTION_ENABLE
 
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""Read and rewrite keymap in EEPROM(EEKEYMAP_ENABLE) of TMK firmware.
+
+Requests are sent as HID feature report of console interface through Linux
+hidraw. Keycodes are numbers in common/keycode.h.
+
+    $ python3 eekeymap.py /dev/hidraw3 info
+    $ python3 eekeymap.py /dev/hidraw3 get 1
+    $ python3 eekeymap.py /dev/hidraw3 set 1 2 3 0x29
+    $ python3 eekeymap.py /dev/hidraw3 reset 1
+
+See common/eekeymap.h.
+"""
+
+import fcntl
+import os
+import sys
+import time
+
+REPORT_SIZE = 32
+GET_INFO, GET_KEYS, SET_KEYS, RESET_LAYER, SAVE = range(1, 6)
+OK, BUSY, INVALID = range(3)
+
+
+def ioc(nr, size):
+    # _IOC(_IOC_READ | _IOC_WRITE, 'H', nr, size)
+    return (3 << 30) | (size << 16) | (ord('H') << 8) | nr
+
+
+class Keyboard:
+    def __init__(self, path):
+        self.fd = os.open(path, os.O_RDWR)
+
+    def request(self, cmd, *args):
+        # report number 0 first
+        buf = bytearray([0, cmd] + list(args))
+        buf += bytes(REPORT_SIZE + 1 - len(buf))
+        fcntl.ioctl(self.fd, ioc(0x06, len(buf)), buf)     # HIDIOCSFEATURE
+        for _ in range(100):
+            res = bytearray(REPORT_SIZE + 1)
+            fcntl.ioctl(self.fd, ioc(0x07, len(res)), res)  # HIDIOCGFEATURE
+            # some kernels strip report number
+            if len(res) > REPORT_SIZE and res[0] == 0 and res[1] == cmd:
+                res = res[1:]
+            if res[0] == cmd and res[1] != BUSY:
+                if res[1] != OK:
+                    raise ValueError('request %d failed: %d' % (cmd, res[1]))
+                return res[2:]
+            time.sleep(0.01)
+        raise TimeoutError('no response')
+
+    def info(self):
+        rows, cols, layers, valid = self.request(GET_INFO)[:4]
+        return rows, cols, layers, valid
+
+    def get_layer(self, layer):
+        rows, cols, _, _ = self.info()
+        codes = []
+        pos = 0
+        while pos < rows * cols:
+            n = min(REPORT_SIZE - 5, rows * cols - pos)
+            codes += self.request(GET_KEYS, layer, pos // cols, pos % cols, n)[:n]
+            pos += n
+        return [codes[r * cols:(r + 1) * cols] for r in range(rows)]
+
+    def set_key(self, layer, row, col, code):
+        self.request(SET_KEYS, layer, row, col, 1, code)
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.stderr.write(__doc__)
+        sys.exit(1)
+    kbd = Keyboard(sys.argv[1])
+    cmd = sys.argv[2]
+    args = [int(a, 0) for a in sys.argv[3:]]
+    if cmd == 'info':
+        rows, cols, layers, valid = kbd.info()
+        print('matrix: %dx%d layers: %d in EEPROM: %s' % (
+            rows, cols, layers, [l for l in range(layers) if valid & (1 << l)]))
+    elif cmd == 'get':
+        for row in kbd.get_layer(args[0]):
+            print(' '.join('%02X' % c for c in row))
+    elif cmd == 'set':
+        kbd.set_key(*args[:4])
+    elif cmd == 'reset':
+        kbd.request(RESET_LAYER, args[0])
+    elif cmd == 'save':
+        kbd.request(SAVE)
+    else:
+        sys.stderr.write('unknown command: %s\n' % cmd)
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
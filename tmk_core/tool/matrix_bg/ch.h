@@ -0,0 +1,44 @@
+/* Host mock of ChibiOS kernel for matrix_bg_test.c */
+#ifndef CH_H
+#define CH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef uint32_t sysinterval_t;
+typedef void (*vtfunc_t)(void *p);
+typedef struct {
+    vtfunc_t func;
+    void *par;
+    sysinterval_t delay;
+    bool armed;
+} virtual_timer_t;
+
+/* 10us system tick, fast enough for MATRIX_BG_INTERVAL */
+#define CH_CFG_ST_FREQUENCY     100000
+#define TIME_US2I(us)   ((sysinterval_t)((us) / 10))
+
+/* lock nesting and timer armed last are checked by test */
+extern int ch_lock;
+extern virtual_timer_t *ch_vt_armed;
+#define chSysLock()             (ch_lock++)
+#define chSysUnlock()           (ch_lock--)
+#define chSysLockFromISR()      (ch_lock++)
+#define chSysUnlockFromISR()    (ch_lock--)
+
+static inline void chVTObjectInit(virtual_timer_t *vtp)
+{
+    vtp->armed = false;
+}
+
+static inline void chVTSetI(virtual_timer_t *vtp, sysinterval_t delay, vtfunc_t vtfunc, void *par)
+{
+    vtp->func = vtfunc;
+    vtp->par = par;
+    vtp->delay = delay;
+    vtp->armed = true;
+    ch_vt_armed = vtp;
+}
+#define chVTSet chVTSetI
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+/* matrix of keys in matrix_bg_test.c */
+#define MATRIX_ROWS 8
+#define MATRIX_COLS 16
+
+#endif
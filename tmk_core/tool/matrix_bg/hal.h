@@ -0,0 +1 @@
+/* Host mock of ChibiOS HAL for matrix_bg_test.c, nothing is needed */
@@ -0,0 +1,151 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Test of background matrix scan(common/chibios/matrix_bg.c)
+ *
+ * Virtual timer of mock ChibiOS is fired by hand as timer interrupt. Board
+ * side of matrix is simulated with key state which can change at any step.
+ * These should hold:
+ *     no scan until all rows are read once
+ *     a row is read only while it is selected, and only one row is selected
+ *     a scan holds state of each row at the step it was read
+ *     a scan is taken once, and the latest one is taken
+ *     timer is rearmed on every step and ISR lock is balanced
+ *
+ *     $ make && ./matrix_bg_test [seed] [steps]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ch.h"
+#include "matrix_bg.h"
+
+
+int ch_lock = 0;
+virtual_timer_t *ch_vt_armed = NULL;
+
+static int failed = 0;
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        printf("FAIL line %d: ", __LINE__); printf(__VA_ARGS__); printf("\n"); \
+        failed++; \
+    } \
+} while (0)
+
+
+/* simulated board */
+static matrix_row_t keys[MATRIX_ROWS];
+static int selected = -1;
+/* key state of each row at the step it was read */
+static matrix_row_t read_state[MATRIX_ROWS];
+static int reads = 0;
+
+void matrix_bg_select_row(uint8_t row)
+{
+    CHECK(selected < 0, "row %d is selected while %d is", row, selected);
+    CHECK(row < MATRIX_ROWS, "invalid row %d", row);
+    selected = row;
+}
+
+void matrix_bg_unselect_rows(void)
+{
+    selected = -1;
+}
+
+matrix_row_t matrix_bg_read_cols(void)
+{
+    CHECK(ch_lock > 0, "read out of lock");
+    CHECK(selected >= 0, "read with no row selected");
+    if (selected < 0) return 0;
+    reads++;
+    read_state[selected] = keys[selected];
+    return keys[selected];
+}
+
+
+/* timer interrupt */
+static void tick(void)
+{
+    virtual_timer_t *vt = ch_vt_armed;
+    CHECK(vt && vt->armed, "timer is not armed");
+    if (!vt || !vt->armed) exit(1);
+    vt->armed = false;
+    vt->func(vt->par);
+    CHECK(ch_lock == 0, "lock is not balanced: %d", ch_lock);
+    CHECK(vt->armed, "timer is not rearmed");
+}
+
+static void check_scan(const matrix_row_t rows[MATRIX_ROWS], const matrix_row_t want[MATRIX_ROWS])
+{
+    for (int r = 0; r < MATRIX_ROWS; r++) {
+        CHECK(rows[r] == want[r], "row %d: %X, expected %X", r, rows[r], want[r]);
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    unsigned seed = (argc > 1) ? strtoul(argv[1], NULL, 0) : 1;
+    int count = (argc > 2) ? atoi(argv[2]) : 100000;
+    matrix_row_t rows[MATRIX_ROWS];
+    matrix_row_t want[MATRIX_ROWS];
+    srand(seed);
+
+    matrix_bg_start();
+    CHECK(ch_lock == 0, "lock is not balanced: %d", ch_lock);
+    CHECK(selected == 0, "first row is not selected at start");
+
+    // no scan until all rows are read once
+    for (int i = 0; i < MATRIX_ROWS - 1; i++) {
+        tick();
+        CHECK(!matrix_bg_read(rows), "scan before all rows are read");
+    }
+    tick();
+    CHECK(matrix_bg_read(rows), "no scan after all rows are read");
+    CHECK(!matrix_bg_read(rows), "scan is taken twice");
+
+    // keys change at random steps and scans are taken at random
+    int scans = 0;
+    int step_in_scan = 0;
+    bool complete = false;
+    for (int i = 0; i < count; i++) {
+        if (rand() % 4 == 0) {
+            keys[rand() % MATRIX_ROWS] ^= (matrix_row_t)1 << (rand() % MATRIX_COLS);
+        }
+        tick();
+        if (++step_in_scan == MATRIX_ROWS) {
+            step_in_scan = 0;
+            memcpy(want, read_state, sizeof(want));
+            complete = true;
+        }
+        if (rand() % (MATRIX_ROWS * 2) == 0) {
+            bool ready = matrix_bg_read(rows);
+            CHECK(ready == complete, "scan ready: %d, expected %d at step %d", ready, complete, i);
+            if (ready) {
+                check_scan(rows, want);
+                scans++;
+            }
+            complete = false;
+        }
+    }
+    CHECK(reads == count + MATRIX_ROWS, "%d reads in %d steps", reads, count + MATRIX_ROWS);
+
+    printf("%d steps, %d scans: %s\n", count, scans, failed ? "FAIL" : "OK");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,173 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Replay key trace on host
+ *
+ * Key events dumped with 't' command(TRACE_ENABLE) are fed into action_exec
+ * of firmware built for host, with pseudo TICK every 1ms as keyboard_task
+ * does. Reports sent to host are printed with time in ms, so that outputs
+ * of two firmware versions can be compared with diff.
+ *
+ *     $ make KEYBOARD=../../../keyboard/gh60 KEYMAP=poker
+ *     $ ./replay trace.txt
+ *
+ * Lines other than "T:" of the dump are ignored, console log can be passed
+ * as is.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "keyboard.h"
+#include "action.h"
+#include "host.h"
+#include "host_driver.h"
+#include "timer.h"
+#include "wait.h"
+#include "debug.h"
+#include "trace.h"
+
+/* ms to run after last event so that pending taps are resolved */
+#define TAIL_TIME   1000
+
+
+/* virtual clock in ms */
+volatile uint32_t timer_count = 0;
+
+void timer_init(void) {}
+void timer_clear(void) { timer_count = 0; }
+uint16_t timer_read(void) { return (uint16_t)timer_count; }
+uint32_t timer_read32(void) { return timer_count; }
+uint16_t timer_elapsed(uint16_t last) { return TIMER_DIFF_16(timer_read(), last); }
+uint32_t timer_elapsed32(uint32_t last) { return TIMER_DIFF_32(timer_read32(), last); }
+
+/* firmware blocks while waiting */
+void wait_ms(uint16_t ms) { timer_count += ms; }
+void wait_us(uint16_t us) { (void)us; }
+
+debug_config_t debug_config;
+void bootloader_jump(void) { printf("%8u: bootloader\n", timer_count); }
+void keyboard_set_leds(uint8_t leds) { (void)leds; }
+
+
+/*
+ * Host driver prints reports
+ */
+static uint8_t keyboard_leds(void) { return 0; }
+
+static void send_keyboard(report_keyboard_t *report)
+{
+    printf("%8u: keyboard", timer_count);
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_SIZE; i++) {
+        printf(" %02X", report->raw[i]);
+    }
+    printf("\n");
+}
+
+static void send_mouse(report_mouse_t *report)
+{
+    printf("%8u: mouse %02X %d %d %d %d\n", timer_count, report->buttons,
+           report->x, report->y, report->v, report->h);
+}
+
+static void send_system(uint16_t data)
+{
+    printf("%8u: system %04X\n", timer_count, data);
+}
+
+static void send_consumer(uint16_t data)
+{
+    printf("%8u: consumer %04X\n", timer_count, data);
+}
+
+static host_driver_t driver = {
+    keyboard_leds,
+    send_keyboard,
+    send_mouse,
+    send_system,
+    send_consumer
+};
+
+
+/* Run keyboard_task at 1ms interval until time */
+static void run_until(uint32_t time)
+{
+    while ((int32_t)(time - timer_count) > 0) {
+        timer_count++;
+        action_exec(TICK);
+    }
+}
+
+static void replay(trace_record_t r)
+{
+    run_until(timer_count + r.delta);
+
+    keyevent_t e = (keyevent_t){
+        .key = (keypos_t){ .row = r.row, .col = r.col & ~TRACE_PRESSED },
+        .pressed = (r.col & TRACE_PRESSED),
+        .time = (timer_read() | 1)
+    };
+    printf("%8u: key %u,%u %s\n", timer_count, e.key.row, e.key.col,
+           e.pressed ? "down" : "up");
+    action_exec(e);
+    action_exec(TICK);
+}
+
+static void replay_file(FILE *f)
+{
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        char *p = strstr(line, "T:");
+        if (!p) continue;
+        p += 2;
+
+        char *end;
+        for (;;) {
+            unsigned long v = strtoul(p, &end, 16);
+            if (end == p) break;
+            p = end;
+            replay((trace_record_t){
+                .row = v >> 24,
+                .col = v >> 16,
+                .delta = v
+            });
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    host_set_driver(&driver);
+
+    if (argc < 2) {
+        replay_file(stdin);
+    }
+    for (int i = 1; i < argc; i++) {
+        FILE *f = fopen(argv[i], "r");
+        if (!f) {
+            perror(argv[i]);
+            return 1;
+        }
+        replay_file(f);
+        fclose(f);
+    }
+    run_until(timer_count + TAIL_TIME);
+    return 0;
+}
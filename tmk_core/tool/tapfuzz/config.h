@@ -0,0 +1,12 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+/* matrix of keys in tapfuzz.c */
+#define MATRIX_ROWS 1
+#define MATRIX_COLS 8
+
+#ifndef TAPPING_TERM
+#define TAPPING_TERM 200
+#endif
+
+#endif
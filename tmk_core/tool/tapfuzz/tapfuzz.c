@@ -0,0 +1,411 @@
+/*
+Copyright 2026 tmk_keyboard contributors
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Property test of tapping state machine
+ *
+ * Random sequences of key events with random intervals around TAPPING_TERM
+ * are fed into action_exec of firmware built for host, with pseudo TICK
+ * every 1ms on virtual clock. After all keys are released and tapping is
+ * settled these should hold:
+ *     no stuck key:   no key, modifier or layer remains on
+ *     no lost press:  a plain key is reported as many times as it is pressed
+ *     tap or hold:    a press of tap key registers its keycode or its hold,
+ *                     the keycode at most once
+ *     tap:            a tap key released just after its press, with no other
+ *                     event between, registers its keycode
+ *     bounded buffer: waiting buffer is empty
+ *     deterministic:  same report stream when replayed at other time
+ * Press and tap are not checked when waiting buffer overflows, it clears all
+ * states by design.
+ *
+ *     $ make && ./tapfuzz [-s seed] [-n count]
+ *     $ make libfuzzer && ./tapfuzz_libfuzzer
+ *
+ * Fixed regression cases are checked first.
+ * Failing case is printed as trace dump(common/trace.h) and aborted.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "keyboard.h"
+#include "keycode.h"
+#include "action.h"
+#include "action_layer.h"
+#include "action_util.h"
+#include "action_tapping.h"
+#include "host.h"
+#include "host_driver.h"
+#include "timer.h"
+#include "wait.h"
+#include "debug.h"
+
+/* keys held at a time, within 6KRO report */
+#define MAX_DOWN    4
+/* events in a random case */
+#define MAX_EVENTS  64
+
+
+/*
+ * Keymap: plain keys, modifier, mods-tap and layer-tap
+ */
+#define NKEYS   MATRIX_COLS
+#define PLAIN(col)  ((col) < 4 || (col) == 7)
+#define TAP_KEY(col)    ((col) >= 4 && (col) <= 6)
+
+static const action_t actionmap[2][NKEYS] = {
+    {
+        ACTION_KEY(KC_A), ACTION_KEY(KC_B), ACTION_KEY(KC_C), ACTION_KEY(KC_D),
+        ACTION_MODS_TAP_KEY(MOD_LSFT, KC_SPC),
+        ACTION_MODS_TAP_KEY(MOD_RCTL, KC_ENT),
+        ACTION_LAYER_TAP_KEY(1, KC_TAB),
+        ACTION_KEY(KC_LALT),
+    },
+    {
+        ACTION_KEY(KC_E), ACTION_KEY(KC_F), ACTION_KEY(KC_G), ACTION_KEY(KC_H),
+        ACTION_TRANSPARENT, ACTION_TRANSPARENT, ACTION_TRANSPARENT, ACTION_TRANSPARENT,
+    },
+};
+
+/* keycode on tap and modifier on hold of tap keys, 0 is layer 1 */
+static const uint8_t tap_code[NKEYS]  = { [4] = KC_SPC,  [5] = KC_ENT,  [6] = KC_TAB };
+static const uint8_t hold_code[NKEYS] = { [4] = KC_LSFT, [5] = KC_RCTL, [6] = 0 };
+
+action_t action_for_key(uint8_t layer, keypos_t key)
+{
+    if (layer > 1 || key.row != 0 || key.col >= NKEYS) {
+        return (action_t)ACTION_NO;
+    }
+    return actionmap[layer][key.col];
+}
+
+const macro_t *action_get_macro(keyrecord_t *record, uint8_t id, uint8_t opt) { return MACRO_NONE; }
+void action_function(keyrecord_t *record, uint8_t id, uint8_t opt) {}
+
+
+/* virtual clock in ms */
+volatile uint32_t timer_count = 0;
+
+void timer_init(void) {}
+void timer_clear(void) { timer_count = 0; }
+uint16_t timer_read(void) { return (uint16_t)timer_count; }
+uint32_t timer_read32(void) { return timer_count; }
+uint16_t timer_elapsed(uint16_t last) { return TIMER_DIFF_16(timer_read(), last); }
+uint32_t timer_elapsed32(uint32_t last) { return TIMER_DIFF_32(timer_read32(), last); }
+
+void wait_ms(uint16_t ms) { timer_count += ms; }
+void wait_us(uint16_t us) { (void)us; }
+
+debug_config_t debug_config;
+void bootloader_jump(void) {}
+void keyboard_set_leds(uint8_t leds) { (void)leds; }
+
+
+/*
+ * Observation of a run
+ */
+static uint32_t base;
+static uint32_t hash;
+static report_keyboard_t last_report;
+static uint16_t presses[NKEYS];
+static uint16_t reported[NKEYS];
+static uint16_t taps[NKEYS];
+static uint16_t tapped[NKEYS];
+static uint16_t held[NKEYS];
+static uint32_t last_layer_state;
+static bool overflowed;
+static uint8_t peak;
+static uint32_t execs = 0;
+static uint32_t overflows = 0;
+
+static bool in_report(const report_keyboard_t *r, uint8_t code)
+{
+    if (IS_MOD(code)) return r->mods & MOD_BIT(code);
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (r->keys[i] == code) return true;
+    }
+    return false;
+}
+
+static void hash_byte(uint8_t b)
+{
+    // FNV-1a
+    hash = (hash ^ b) * 16777619;
+}
+
+static uint8_t keyboard_leds(void) { return 0; }
+
+static void send_keyboard(report_keyboard_t *report)
+{
+    uint32_t t = timer_count - base;
+    for (uint8_t i = 0; i < 4; i++) hash_byte(t >> (i * 8));
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_SIZE; i++) hash_byte(report->raw[i]);
+
+    // count new appearance of code of plain keys on any layer
+    for (uint8_t col = 0; col < NKEYS; col++) {
+        if (!PLAIN(col)) continue;
+        for (uint8_t layer = 0; layer < 2; layer++) {
+            action_t a = actionmap[layer][col];
+            if (a.kind.id != ACT_LMODS) continue;
+            if (in_report(report, a.key.code) && !in_report(&last_report, a.key.code)) {
+                reported[col]++;
+            }
+        }
+    }
+    // count new appearance of keycode and modifier of tap keys
+    for (uint8_t col = 0; col < NKEYS; col++) {
+        if (!TAP_KEY(col)) continue;
+        if (in_report(report, tap_code[col]) && !in_report(&last_report, tap_code[col])) {
+            tapped[col]++;
+        }
+        if (hold_code[col] && in_report(report, hold_code[col]) && !in_report(&last_report, hold_code[col])) {
+            held[col]++;
+        }
+    }
+    last_report = *report;
+}
+
+void hook_layer_change(uint32_t state)
+{
+    // layer 1 is only from layer-tap key
+    for (uint8_t col = 0; col < NKEYS; col++) {
+        if (TAP_KEY(col) && !hold_code[col] && (state & 2) && !(last_layer_state & 2)) {
+            held[col]++;
+        }
+    }
+    last_layer_state = state;
+}
+
+static void send_mouse(report_mouse_t *report) {}
+static void send_system(uint16_t data) {}
+static void send_consumer(uint16_t data) {}
+
+static host_driver_t driver = {
+    keyboard_leds,
+    send_keyboard,
+    send_mouse,
+    send_system,
+    send_consumer
+};
+
+
+/*
+ * Run a case
+ *
+ * Input is pairs of bytes: key to toggle and time before the event in
+ * 1/128 of TAPPING_TERM.
+ */
+typedef struct {
+    uint8_t col;
+    bool pressed;
+    uint16_t delta;
+} event_t;
+
+static event_t events[MAX_EVENTS * 2 + NKEYS];
+static uint16_t nevents;
+
+static void decode(const uint8_t *data, size_t size)
+{
+    bool down[NKEYS] = {};
+    uint8_t ndown = 0;
+
+    nevents = 0;
+    for (size_t i = 0; i + 1 < size && nevents < MAX_EVENTS * 2; i += 2) {
+        uint8_t col = data[i] % NKEYS;
+        if (!down[col] && ndown >= MAX_DOWN) continue;
+        down[col] = !down[col];
+        ndown += down[col] ? 1 : -1;
+        events[nevents++] = (event_t){ col, down[col], (uint32_t)data[i + 1] * TAPPING_TERM / 128 };
+    }
+    // release all at last
+    for (uint8_t col = 0; col < NKEYS; col++) {
+        if (down[col]) events[nevents++] = (event_t){ col, false, 1 };
+    }
+}
+
+static void run_until(uint32_t time)
+{
+    while ((int32_t)(time - timer_count) > 0) {
+        timer_count++;
+        action_exec(TICK);
+    }
+}
+
+static void print_case(void)
+{
+    // trace dump format: row, col | pressed, delta
+    printf("T:");
+    for (uint16_t i = 0; i < nevents; i++) {
+        printf(" %02X%02X%04X", 0, events[i].col | (events[i].pressed ? 0x80 : 0), events[i].delta);
+        if (i % 8 == 7 && i != nevents - 1) printf("\nT:");
+    }
+    printf("\n");
+}
+
+static void fail(const char *msg)
+{
+    printf("FAIL: %s\n", msg);
+    printf("exec: %u base: %u TAPPING_TERM: %u\n", execs, base, TAPPING_TERM);
+    print_case();
+    fflush(stdout);
+    abort();
+}
+
+static uint32_t run(uint32_t start)
+{
+    base = timer_count = start;
+    hash = 2166136261u;
+    last_report = (report_keyboard_t){};
+    memset(presses, 0, sizeof(presses));
+    memset(reported, 0, sizeof(reported));
+    memset(taps, 0, sizeof(taps));
+    memset(tapped, 0, sizeof(tapped));
+    memset(held, 0, sizeof(held));
+    last_layer_state = layer_state;
+    overflowed = false;
+
+    for (uint16_t i = 0; i < nevents; i++) {
+        run_until(timer_count + events[i].delta);
+
+        keyevent_t e = (keyevent_t){
+            .key = (keypos_t){ .row = 0, .col = events[i].col },
+            .pressed = events[i].pressed,
+            .time = (timer_read() | 1)
+        };
+        if (action_tapping_waiting() >= WAITING_BUFFER_SIZE - 1) {
+            overflowed = true;
+        }
+        if (e.pressed) presses[e.key.col]++;
+        // tap: released by next event well within TAPPING_TERM
+        if (e.pressed && TAP_KEY(e.key.col) && i + 1 < nevents &&
+                events[i + 1].col == e.key.col && events[i + 1].delta + 2 < TAPPING_TERM) {
+            taps[e.key.col]++;
+        }
+        action_exec(e);
+        action_exec(TICK);
+
+        uint8_t n = action_tapping_waiting();
+        if (n > peak) peak = n;
+    }
+    run_until(timer_count + TAPPING_TERM * 2 + 10);
+
+    if (action_tapping_waiting()) fail("waiting buffer is not empty");
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_SIZE; i++) {
+        if (last_report.raw[i]) fail("stuck key in report");
+    }
+    if (get_mods() || get_weak_mods()) fail("stuck modifier");
+    if (layer_state) fail("stuck layer");
+    if (!overflowed) {
+        for (uint8_t col = 0; col < NKEYS; col++) {
+            if (PLAIN(col) && presses[col] != reported[col]) fail("lost or extra press");
+            if (!TAP_KEY(col)) continue;
+            if (tapped[col] > presses[col]) fail("extra keycode of tap key");
+            if (tapped[col] + held[col] < presses[col]) fail("press of tap key without keycode nor hold");
+            if (tapped[col] < taps[col]) fail("tap of tap key without keycode");
+        }
+    }
+    return hash;
+}
+
+static void check(const uint8_t *data, size_t size, uint32_t start)
+{
+    decode(data, size);
+    uint32_t h = run(start);
+    if (overflowed) overflows++;
+    // around wraparound of 16-bit timer, same parity for time | 1
+    if (run(0xFF00 + (start & 0xFE)) != h) fail("different report stream");
+    execs++;
+}
+
+/* fixed cases in same format as random input */
+static const uint8_t regressions[][8] = {
+    // hold LSFT/SPC over TAPPING_TERM and tap RCTL/ENT in it: Shift+Enter
+    { 4, 0, 5, 16, 5, 16, 4, 255 },
+};
+
+static void check_regressions(void)
+{
+    for (uint8_t i = 0; i < sizeof(regressions) / sizeof(regressions[0]); i++) {
+        check(regressions[i], sizeof(regressions[i]), 0x1000);
+    }
+}
+
+
+#ifdef TAPFUZZ_LIBFUZZER
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    static bool init = false;
+    if (!init) {
+        host_set_driver(&driver);
+        check_regressions();
+        init = true;
+    }
+    check(data, size, 0x1000);
+    return 0;
+}
+#else
+static uint32_t xorshift32(uint32_t *s)
+{
+    *s ^= *s << 13;
+    *s ^= *s >> 17;
+    *s ^= *s << 5;
+    return *s;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t seed = time(NULL);
+    uint32_t count = 0;     // forever
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "-s")) seed = strtoul(argv[i + 1], NULL, 0);
+        else if (!strcmp(argv[i], "-n")) count = strtoul(argv[i + 1], NULL, 0);
+    }
+    printf("seed: %u TAPPING_TERM: %u\n", seed, TAPPING_TERM);
+    if (!seed) seed = 1;
+
+    host_set_driver(&driver);
+    check_regressions();
+
+    uint8_t data[MAX_EVENTS * 2];
+    struct timespec t0, t;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    uint32_t last_execs = 0;
+    double last = 0;
+    while (!count || execs < count) {
+        size_t size = 2 + xorshift32(&seed) % (sizeof(data) - 1);
+        for (size_t i = 0; i < size; i++) data[i] = xorshift32(&seed);
+        // time base is even, see check
+        check(data, size, xorshift32(&seed) & 0xFFFFFE);
+
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        double now = (t.tv_sec - t0.tv_sec) + (t.tv_nsec - t0.tv_nsec) / 1e9;
+        if (now - last >= 1.0) {
+            printf("%u execs, %.0f exec/s, peak buffer %u, overflow %u\n",
+                   execs, (execs - last_execs) / (now - last), peak, overflows);
+            fflush(stdout);
+            last = now;
+            last_execs = execs;
+        }
+    }
+    printf("%u execs, peak buffer %u, overflow %u: OK\n", execs, peak, overflows);
+    return 0;
+}
+#endif
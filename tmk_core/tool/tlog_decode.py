@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+"""Decode tokenized log(TLOG_ENABLE) of TMK firmware.
+
+Records streamed from console are decoded with format strings read from
+firmware ELF file. Text output from print/xprintf passes through as is.
+
+    $ python3 tlog_decode.py firmware.elf /dev/hidraw3
+    $ hid_listen | python3 tlog_decode.py firmware.elf
+
+Record: 0x1E, length, format address(pointer size), arguments
+Bytes after 0x1E are stuffed with escape 0x1F. See common/tlog.h.
+"""
+
+import struct
+import sys
+
+TLOG_MARKER = 0x1E
+TLOG_ESC = 0x1F
+EM_AVR = 83
+AVR_RAM_OFFSET = 0x800000
+
+
+class Elf:
+    """Minimal ELF reader to fetch strings at target address"""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF' or self.data[4] not in (1, 2):
+            raise ValueError('not ELF file: ' + path)
+        # ELF64 for host native build
+        self.elf64 = (self.data[4] == 2)
+        self.machine = struct.unpack_from('<H', self.data, 18)[0]
+        if self.elf64:
+            shoff, = struct.unpack_from('<Q', self.data, 40)
+            shentsize, shnum = struct.unpack_from('<HH', self.data, 58)
+            sh = '<IIQQQQ'
+        else:
+            shoff, = struct.unpack_from('<I', self.data, 32)
+            shentsize, shnum = struct.unpack_from('<HH', self.data, 46)
+            sh = '<IIIIII'
+        self.sections = []
+        for i in range(shnum):
+            (name, stype, flags, addr, offset, size) = struct.unpack_from(
+                sh, self.data, shoff + i * shentsize)
+            # allocated PROGBITS only
+            if stype == 1 and flags & 0x2 and size:
+                self.sections.append((addr, offset, size))
+
+    @property
+    def is_avr(self):
+        return self.machine == EM_AVR
+
+    @property
+    def int_size(self):
+        return 2 if self.is_avr else 4
+
+    @property
+    def long_size(self):
+        return 8 if self.elf64 else 4
+
+    @property
+    def ptr_size(self):
+        if self.elf64:
+            return 8
+        return 2 if self.is_avr else 4
+
+    def string(self, addr, ram=False):
+        if ram and self.is_avr:
+            addr |= AVR_RAM_OFFSET
+        for (saddr, offset, size) in self.sections:
+            if saddr <= addr < saddr + size:
+                start = offset + addr - saddr
+                end = self.data.index(b'\0', start)
+                return self.data[start:end].decode('latin-1')
+        return None
+
+
+def unpack(buf, pos, size, signed=False):
+    fmt = {1: 'b', 2: 'h', 4: 'i', 8: 'q'}[size]
+    if not signed:
+        fmt = fmt.upper()
+    return struct.unpack_from('<' + fmt, buf, pos)[0], pos + size
+
+
+def xprintf(elf, fmt, args):
+    """Format like common/avr/xprintf.S"""
+    out = []
+    pos = 0
+    i = 0
+    while i < len(fmt):
+        c = fmt[i]
+        i += 1
+        if c != '%':
+            out.append(c)
+            continue
+        zero = False
+        width = 0
+        if i < len(fmt) and fmt[i] == '0':
+            zero = True
+            i += 1
+        while i < len(fmt) and fmt[i].isdigit():
+            width = width * 10 + int(fmt[i])
+            i += 1
+        size = elf.int_size
+        if i < len(fmt) and fmt[i] == 'l':
+            size = elf.long_size
+            i += 1
+        if i >= len(fmt):
+            break
+        t = fmt[i]
+        i += 1
+        if t == '%':
+            out.append('%')
+            continue
+        if t in 'sS':
+            try:
+                p, pos = unpack(args, pos, elf.ptr_size)
+            except struct.error:
+                out.append('<?>')
+                continue
+            s = elf.string(p, ram=(t == 's'))
+            out.append(s if s is not None else '<%#x>' % p)
+            continue
+        try:
+            v, pos = unpack(args, pos, size, signed=(t == 'd'))
+        except struct.error:
+            out.append('<?>')
+            continue
+        if t == 'c':
+            s = chr(v & 0xFF)
+        elif t in 'du':
+            s = str(v)
+        elif t == 'X':
+            s = '%X' % v
+        elif t == 'b':
+            s = bin(v)[2:]
+        else:
+            s = '%' + t
+        out.append(s.rjust(width, '0' if zero else ' '))
+    return ''.join(out)
+
+
+def record(elf, rec, out):
+    addr, _ = unpack(rec, 0, elf.ptr_size)
+    args = bytes(rec[elf.ptr_size:])
+    if addr == 0:
+        n = struct.unpack_from('<H', args)[0] if len(args) >= 2 else 0
+        out.write('[tlog: %d records dropped]\n' % n)
+        return
+    fmt = elf.string(addr)
+    if fmt is None:
+        out.write('[tlog: unknown format %#x]\n' % addr)
+    else:
+        out.write(xprintf(elf, fmt, args))
+
+
+def decode(elf, stream, out):
+    length = None       # None: text, -1: reading length
+    esc = False
+    rec = bytearray()
+    while True:
+        chunk = stream.read(1)
+        if not chunk:
+            break
+        b = chunk[0]
+        # console padding
+        if b == 0x00:
+            continue
+        if b == TLOG_MARKER:
+            if length is not None:
+                out.write('[tlog: broken record]\n')
+            length = -1
+            esc = False
+            rec = bytearray()
+            continue
+        if length is None:
+            out.write(chr(b))
+            out.flush()
+            continue
+        # newline never appears in record; byte lost and text follows
+        if b == 0x0A:
+            out.write('[tlog: broken record]\n')
+            length = None
+            continue
+        if b == TLOG_ESC:
+            esc = True
+            continue
+        if esc:
+            b ^= 0x20
+            esc = False
+        if length < 0:
+            length = b
+        else:
+            rec.append(b)
+        if length >= 0 and len(rec) == length:
+            if length >= elf.ptr_size:
+                record(elf, rec, out)
+            length = None
+            out.flush()
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.stderr.write('Usage: %s firmware.elf [input]\n' % sys.argv[0])
+        sys.exit(1)
+    elf = Elf(sys.argv[1])
+    if len(sys.argv) > 2:
+        stream = open(sys.argv[2], 'rb', buffering=0)
+    else:
+        stream = sys.stdin.buffer
+    try:
+        decode(elf, stream, sys.stdout)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
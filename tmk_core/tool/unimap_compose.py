@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+"""Compose unimap_trans and actionmaps into matrix-indexed action table.
+
+actionmaps[layer][UNIMAP_ROWS][UNIMAP_COLS] and unimap_trans[ROWS][COLS] are
+read from object files of keymap and composed into C source of
+actionmaps_matrix[layer][ROWS * COLS], so that action_for_key reads flash
+only once(UNIMAP_PRECOMPOSE). Called from rules.mk.
+
+With --sparse only non-transparent actions of each layer are stored with
+bitmap of them(UNIMAP_SPARSE), so that more layers fit in flash.
+
+    $ python3 unimap_compose.py [--sparse] unimap_matrix.c obj_alps64/unimap_plain.o ...
+
+Object files which don't define the tables are ignored.
+See common/unimap.c.
+"""
+
+import struct
+import sys
+
+UNIMAP_ROWS = 8
+UNIMAP_COLS = 16
+UNIMAP_NO = 0x80
+ACTION_NO = 0x0000
+ACTION_TRANSPARENT = 0x0001
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+
+
+def read_symbols(path, names):
+    """Returns {name: bytes} of symbols defined in relocatable ELF file"""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:4] != b'\x7fELF' or data[4] not in (1, 2):
+        return {}
+    # ELF64 for host native build
+    if data[4] == 2:
+        shoff, = struct.unpack_from('<Q', data, 40)
+        shentsize, shnum = struct.unpack_from('<HH', data, 58)
+        sh = '<IIQQQQI'
+        sym, symsize = '<IBBHQQ', 24
+    else:
+        shoff, = struct.unpack_from('<I', data, 32)
+        shentsize, shnum = struct.unpack_from('<HH', data, 46)
+        sh = '<IIIIIII'
+        sym, symsize = '<IIIBBH', 16
+    sections = [struct.unpack_from(sh, data, shoff + i * shentsize)
+                for i in range(shnum)]
+
+    found = {}
+    for (_, stype, _, _, offset, size, link) in sections:
+        if stype != SHT_SYMTAB:
+            continue
+        stroff = sections[link][4]
+        for pos in range(offset, offset + size, symsize):
+            if data[4] == 2:
+                (name, _, _, shndx, value, ssize) = struct.unpack_from(sym, data, pos)
+            else:
+                (name, value, ssize, _, _, shndx) = struct.unpack_from(sym, data, pos)
+            end = data.index(b'\0', stroff + name)
+            sname = data[stroff + name:end].decode('latin-1')
+            if sname not in names or not 0 < shndx < len(sections):
+                continue
+            (_, ttype, _, _, toffset, _, _) = sections[shndx]
+            if ttype == SHT_NOBITS:
+                found[sname] = bytes(ssize)
+            else:
+                found[sname] = data[toffset + value:toffset + value + ssize]
+    return found
+
+
+def compose(actionmaps, trans):
+    """Returns layers of actions in order of matrix position"""
+    layer_size = UNIMAP_ROWS * UNIMAP_COLS * 2
+    if not actionmaps or len(actionmaps) % layer_size:
+        raise ValueError('wrong size of actionmaps: %d' % len(actionmaps))
+    layers = []
+    for l in range(len(actionmaps) // layer_size):
+        actions = []
+        for pos in trans:
+            if pos == UNIMAP_NO:
+                actions.append(ACTION_NO)
+                continue
+            # same as unimap_translate and action_for_key
+            row, col = (pos >> 4) & 0x7, pos & 0xf
+            i = l * layer_size + (row * UNIMAP_COLS + col) * 2
+            actions.append(struct.unpack_from('<H', actionmaps, i)[0])
+        layers.append(actions)
+    return layers
+
+
+def write_matrix(f, layers):
+    f.write('const action_t actionmaps_matrix[][MATRIX_ROWS * MATRIX_COLS] PROGMEM = {\n')
+    for actions in layers:
+        f.write('    {\n')
+        for i in range(0, len(actions), 8):
+            f.write('        %s,\n' % ', '.join(
+                '0x%04X' % a for a in actions[i:i + 8]))
+        f.write('    },\n')
+    f.write('};\n')
+
+
+def write_sparse(f, layers):
+    index, base, packed = [], [], []
+    for actions in layers:
+        base.append(len(packed))
+        entries = []
+        for i in range(0, len(actions), 8):
+            bits = 0
+            rank = len(entries)
+            for j, a in enumerate(actions[i:i + 8]):
+                if a != ACTION_TRANSPARENT:
+                    bits |= 1 << j
+                    entries.append(a)
+            index.append((bits, rank))
+        packed += entries
+    if any(rank > 0xFF for (_, rank) in index):
+        raise ValueError('matrix is too large for sparse table')
+
+    keys = len(layers[0])
+    size = len(index) * 2 + len(base) * 2 + len(packed) * 2
+    f.write('/* %d layers: %d actions, %d bytes(%d bytes in matrix table) */\n' % (
+        len(layers), len(packed), size, len(layers) * keys * 2))
+    f.write('const uint8_t actionmaps_index[][UNIMAP_SPARSE_INDEX][2] PROGMEM = {\n')
+    n = (keys + 7) // 8
+    for l in range(len(layers)):
+        f.write('    {\n')
+        for i in range(0, n, 4):
+            f.write('        %s,\n' % ', '.join(
+                '{ 0x%02X, %3d }' % e for e in index[l * n + i:l * n + min(i + 4, n)]))
+        f.write('    },\n')
+    f.write('};\n\n')
+    f.write('const uint16_t actionmaps_base[] PROGMEM = { %s };\n\n' % (
+        ', '.join('%d' % b for b in base)))
+    f.write('const action_t actionmaps_packed[] PROGMEM = {\n')
+    for i in range(0, len(packed), 8):
+        f.write('    %s,\n' % ', '.join('0x%04X' % a for a in packed[i:i + 8]))
+    if not packed:
+        f.write('    0x%04X,\n' % ACTION_TRANSPARENT)
+    f.write('};\n')
+
+
+def main():
+    sparse = (len(sys.argv) > 1 and sys.argv[1] == '--sparse')
+    args = sys.argv[2:] if sparse else sys.argv[1:]
+    if len(args) < 2:
+        sys.stderr.write(__doc__)
+        sys.exit(1)
+    tables = {}
+    for path in args[1:]:
+        tables.update(read_symbols(path, ('actionmaps', 'unimap_trans')))
+    for name in ('actionmaps', 'unimap_trans'):
+        if name not in tables:
+            sys.stderr.write('%s is not found in objects\n' % name)
+            sys.exit(1)
+    trans = tables['unimap_trans']
+    layers = compose(tables['actionmaps'], trans)
+
+    with open(args[0], 'w') as f:
+        f.write('/* Generated by tool/unimap_compose.py. Do not edit. */\n')
+        f.write('#include "progmem.h"\n')
+        f.write('#include "unimap.h"\n\n')
+        f.write('#if (MATRIX_ROWS * MATRIX_COLS != %d)\n' % len(trans))
+        f.write('#   error "MATRIX_ROWS * MATRIX_COLS doesn\'t match unimap_trans."\n')
+        f.write('#endif\n\n')
+        if sparse:
+            write_sparse(f, layers)
+        else:
+            write_matrix(f, layers)
+
+
+if __name__ == '__main__':
+    main()